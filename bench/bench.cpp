@@ -0,0 +1,255 @@
+/**
+ * @file bench.cpp
+ * @brief AVRLite microbenchmarks, run headless under simavr by the avrlite_bench target
+ * Measures the cycles per call of the public API with the free-running Timer1 counter and
+ * the cost and latency of the timer interrupts with the profiling probes (Profile.h).
+ *
+ * @details
+ * - Calls are timed with interrupts off, so no ISR lands inside a measurement.
+ * - Results go out over Serial, one line each, parsed by tools/bench.py:
+ *     BENCH <name> <min cycles> <avg cycles>
+ *     ISR <name> <count> <min> <avg> <max>
+ *     LATENCY <min> <max>
+ *     THROUGHPUT <name> <units> <cycles> <ideal cycles, 0 if there is no bound>
+ *     STAT <name> <value>
+ * - SPI, EEPROM and the encoder run after the timer interrupt measurement, so their pins and
+ *   interrupts stay out of it.
+ * - The firmware ends with interrupts off in sleep mode, which stops simavr.
+ */
+
+#include "AVRLite.h"
+#include "Profile.h"
+#include "RingBuffer.h"
+#include "FixedPoint.h"
+#include "SPI.h"
+#include "EEPROM.h"
+#include "Encoder.h"
+#include "Telemetry.h"
+#include "Scan.h"
+#include "Work.h"
+#include <avr/sleep.h>
+#include <stdlib.h>
+
+#define BENCH_ITERATIONS 16
+
+// Keeps results alive so the optimizer cannot drop the measured calls
+static volatile int32_t bench_sink;
+static volatile float bench_float = 1.0f;
+static uint16_t bench_overhead;
+
+static RingBuffer<uint8_t, 16> bench_ring;
+static uint8_t bench_buffer[64];
+
+// Time `body` BENCH_ITERATIONS times and print the best and the average cycles per call,
+// `prepare` runs untimed with interrupts on before each call
+#define BENCH_AFTER(name, prepare, body)                                           \
+    do {                                                                           \
+        uint16_t best = 0xFFFF;                                                    \
+        uint32_t total = 0;                                                        \
+        for (uint8_t i = 0; i < BENCH_ITERATIONS; i++) {                           \
+            prepare;                                                               \
+            cli();                                                                 \
+            uint16_t start = TCNT1;                                                \
+            body;                                                                  \
+            uint16_t cycles = TCNT1 - start - bench_overhead;                      \
+            sei();                                                                 \
+            if (cycles < best)                                                     \
+                best = cycles;                                                     \
+            total += cycles;                                                       \
+        }                                                                          \
+        Serial_printf_P(PSTR("BENCH %S %u %lu\n"), PSTR(name), best, total / BENCH_ITERATIONS); \
+    } while (0)
+#define BENCH(name, body) BENCH_AFTER(name, , body)
+
+static void __benchIsr__(uint8_t id, PGM_P name) {
+    Profile_Probe probe;
+    Profile_read(id, &probe);
+    Serial_printf_P(PSTR("ISR %S %lu %u %lu %u\n"), name, probe.count, probe.min,
+                    probe.count ? probe.total / probe.count : 0, probe.max);
+}
+
+// Work item for the Work_post cases, never run while timed
+static void __benchWork__(uint16_t arg) {
+    bench_sink = arg;
+}
+
+// Best cycles for `edges` quadrature steps driven on D2/D3, a multiple of 4 so AB ends at 11
+static uint16_t __benchEncoder__(uint8_t edges) {
+    static const uint8_t gray[4] = {0x0, 0x1, 0x3, 0x2};
+    uint16_t best = 0xFFFF;
+    for (uint8_t i = 0; i < BENCH_ITERATIONS; i++) {
+        uint16_t start = TCNT1;
+        for (uint8_t e = 1; e <= edges; e++) {
+            uint8_t ab = gray[(e + 2) & 3];
+            GPIOWrite(D2, ab & 0x2 ? HIGH : LOW);
+            GPIOWrite(D3, ab & 0x1 ? HIGH : LOW);
+        }
+        uint16_t cycles = TCNT1 - start;
+        if (cycles < best)
+            best = cycles;
+    }
+    return best;
+}
+
+int main() {
+    Serial_begin<1000000>();
+    // Starts Timer1, the cycle counter
+    uptimeMs();
+
+    // Cost of the measurement itself, subtracted from every result
+    for (uint8_t i = 0; i < BENCH_ITERATIONS; i++) {
+        cli();
+        uint16_t start = TCNT1;
+        uint16_t cycles = TCNT1 - start;
+        sei();
+        if (i == 0 || cycles < bench_overhead)
+            bench_overhead = cycles;
+    }
+
+    GPIOInit(D13, OUTPUT);
+    BENCH("GPIOInit", GPIOInit(D12, OUTPUT));
+    BENCH("GPIOWrite_digital", GPIOWrite(D13, HIGH));
+    BENCH("GPIOControl_digital", GPIOControl(D13, LOW));
+    BENCH("GPIORead_digital", bench_sink = GPIORead(D2, DIGITALREAD));
+    BENCH("GPIORead_analog", bench_sink = GPIORead(A0, ANALOGREAD));
+    BENCH("GPIOWrite_pwm", GPIOWrite(D3, ANALOGWRITE, 128));
+    BENCH("uptimeMs", bench_sink = uptimeMs());
+    BENCH("uptimeUs", bench_sink = uptimeUs());
+    BENCH("sleepMicroseconds_10", sleepMicroseconds(10));
+    Serial_flush();
+    BENCH("Serial_queue", Serial_queue(' '));
+    Serial_flush();
+    Serial_flush();
+    BENCH("Serial_printf_int", Serial_printf("%d\n", 12345));
+    BENCH("Serial_printf_P_int", Serial_printf_P(PSTR("%d\n"), 12345));
+    BENCH_AFTER("RingBuffer_push", bench_ring.clear(), bench_ring.push(1));
+    BENCH_AFTER("RingBuffer_pop", bench_ring.push(1), { uint8_t c; bench_ring.pop(c); bench_sink = c; });
+    // Posting into an empty queue, and a coalescing post compared against 4 pending items
+    BENCH_AFTER("Work_post", Work_run(255), Work_post(__benchWork__, 1, WORK_NORMAL));
+    BENCH_AFTER("Work_post_coalesce_4", {
+        Work_run(255);
+        for (uint8_t n = 0; n < 4; n++)
+            Work_post(__benchWork__, n, WORK_NORMAL);
+    }, Work_post(__benchWork__, 9, WORK_NORMAL | WORK_COALESCE));
+    Work_run(255);
+    // Fixed point against the soft-float library for the same operation
+    BENCH("Q16_16_add", bench_sink = Q16_16_add(bench_sink, Q16_16(1.25)));
+    BENCH("float_add", bench_float = bench_float + 1.25f);
+    BENCH("Q16_16_mul", bench_sink = Q16_16_mul(bench_sink, Q16_16(1.5)));
+    BENCH("float_mul", bench_float = bench_float * 1.5f);
+    BENCH("Q8_8_div", bench_sink = Q8_8_div(bench_sink, Q8_8(1.5)));
+    BENCH("float_div", bench_float = bench_float / 1.5f);
+    BENCH("Q1_15_sin", bench_sink = Q1_15_sin(bench_sink + 1234));
+    BENCH("atan2Angle", bench_sink = atan2Angle(300, -700));
+    BENCH("isqrt32", bench_sink = isqrt32(123456789UL));
+    BENCH("gamma16", bench_sink = gamma16(40000));
+    // Everything an empty PROFILE_BEGIN/PROFILE_END pair adds to instrumented code
+    BENCH("Profile_probe", { PROFILE_BEGIN(); PROFILE_END(PROFILE_USER); });
+
+    // Timer interrupt cost and latency while the main loop keeps the pins busy
+    Profile_reset();
+    unsigned long start = uptimeMs();
+    while (uptimeMs() - start < 100) {
+        GPIOWrite(D13, HIGH);
+        GPIOWrite(D13, LOW);
+    }
+    __benchIsr__(PROFILE_TIMER0, PSTR("TIMER0_OVF_vect"));
+    __benchIsr__(PROFILE_TIMER1, PSTR("TIMER1_COMPA_vect"));
+
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t latencyMin = profile_latency_min, latencyMax = profile_latency_max;
+    SREG = oldSREG;
+    Serial_printf_P(PSTR("LATENCY %u %u\n"), latencyMin, latencyMax);
+
+    // Telemetry: build, CRC and COBS-encode a frame into an empty transmit buffer
+    Telemetry_begin(TELEMETRY_BLOCK);
+    BENCH_AFTER("Telemetry_frame", Serial_flush(), {
+        Telemetry_startFrame();
+        Telemetry_addU16(0, 1234);
+        Telemetry_addI32(1, bench_sink);
+        Telemetry_addFloat(2, 1.5f);
+        bench_sink = Telemetry_send();
+    });
+    Serial_flush();
+    Serial_println_P(PSTR(""));
+
+    // SPI: polled burst at the fastest clock against 8 SCK periods per byte
+    SPI_Device device;
+    SPI_begin();
+    SPI_device(&device, D8, SPI_MODE0, SPI_MAX_CLOCK);
+    SPI_select(&device);
+    BENCH("SPI_transfer", bench_sink = SPI_transfer(0x55));
+    cli();
+    uint16_t spiStart = TCNT1;
+    SPI_write(bench_buffer, sizeof(bench_buffer));
+    uint16_t spiCycles = TCNT1 - spiStart - bench_overhead;
+    sei();
+    SPI_deselect(&device);
+    Serial_printf_P(PSTR("THROUGHPUT SPI_write %u %u %lu\n"), (uint16_t)sizeof(bench_buffer), spiCycles,
+                    (unsigned long)sizeof(bench_buffer) * 8 * (F_CPU / SPI_MAX_CLOCK));
+
+    // EEPROM: queueing cost, how long a burst larger than the cache stalls the caller, and the
+    // bytes physically written (wear) per ring record and per unchanged block
+    BENCH_AFTER("EEPROM_write", EEPROM_flush(), EEPROM_write(0x100, (uint8_t)++bench_sink));
+    BENCH_AFTER("EEPROM_write_unchanged", EEPROM_flush(), EEPROM_write(0x100, (uint8_t)bench_sink));
+    for (uint8_t i = 0; i < sizeof(bench_buffer); i++)
+        bench_buffer[i] = i;
+    EEPROM_flush();
+    unsigned long stallStart = uptimeUs();
+    EEPROM_writeBlock(0x140, bench_buffer, 2 * EEPROM_CACHE_SIZE);
+    unsigned long stall = uptimeUs() - stallStart;
+    EEPROM_flush();
+    Serial_printf_P(PSTR("STAT EEPROM_writeBlock_stall_us %lu\n"), stall);
+
+    unsigned long writes = EEPROM_writes();
+    EEPROM_writeBlock(0x140, bench_buffer, 2 * EEPROM_CACHE_SIZE);
+    EEPROM_flush();
+    Serial_printf_P(PSTR("STAT EEPROM_writeBlock_unchanged_bytes %lu\n"), EEPROM_writes() - writes);
+
+    EEPROM_Ring ring;
+    EEPROM_ringBegin(&ring, 0x200, 4, 8);
+    writes = EEPROM_writes();
+    EEPROM_ringWrite(&ring, bench_buffer);
+    EEPROM_flush();
+    Serial_printf_P(PSTR("STAT EEPROM_ringWrite_bytes %lu\n"), EEPROM_writes() - writes);
+
+    // Encoder: the pins are driven as outputs, which still raises their pin change interrupt.
+    // The same steps with the interrupt off give the loop cost, the rest is the decoder.
+    int encoder = Encoder_begin(D2, D3);
+    GPIOInit(D2, OUTPUT);
+    GPIOInit(D3, OUTPUT);
+    uint8_t pcicr = PCICR;
+    PCICR = 0;
+    uint16_t encoderLoop = __benchEncoder__(32);
+    PCICR = pcicr;
+    Encoder_write(encoder, 0);
+    uint16_t encoderCycles = __benchEncoder__(32) - encoderLoop;
+    Serial_printf_P(PSTR("THROUGHPUT Encoder_edges 32 %u 0\n"), encoderCycles);
+    Serial_printf_P(PSTR("STAT Encoder_errors %lu\n"), Encoder_errors(encoder));
+    // Every driven edge is one step (4 per cycle), in one direction: a lossless decoder counts
+    // all BENCH_ITERATIONS * 32 of them, Encoder_missed (lost or extra steps) has to stay 0
+    long encoderSteps = labs(Encoder_read(encoder));
+    Serial_printf_P(PSTR("STAT Encoder_count %ld\n"), encoderSteps);
+    Serial_printf_P(PSTR("STAT Encoder_missed %ld\n"), labs(BENCH_ITERATIONS * 32L - encoderSteps));
+
+    // Scan: one row tick of a 4-digit display (rows A0-A3, segments D4-D7) at 100 frames/s
+    static const uint8_t scanRows[4] = {A0, A1, A2, A3};
+    static const uint8_t scanData[4] = {D4, D5, D6, D7};
+    Scan_begin(scanRows, 4, scanData, 4, 0, 100);
+    Profile_reset();
+    start = uptimeMs();
+    while (uptimeMs() - start < 100)
+        Scan_write(0, bench_sink);
+    Scan_end();
+    __benchIsr__(PROFILE_TIMER2, PSTR("TIMER2_COMPA_vect"));
+
+    Serial_println_P(PSTR("DONE"));
+    Serial_flush();
+
+    // Sleeping with interrupts off ends the simulation
+    cli();
+    sleep_enable();
+    sleep_cpu();
+    for (;;);
+}
@@ -0,0 +1,144 @@
+/**
+ * @file bootloader.cpp
+ * @brief AVRLite serial bootloader for the ATmega328P, 512 bytes at 0x7E00 (avrlite_bootloader)
+ * Programs the application over USART0 at 1 Mbaud (U2X) and is driven by tools/avrlite_upload.
+ *
+ * @details
+ * - Fuses: hfuse 0xDE (BOOTSZ = 256 words, BOOTRST), same layout as the Uno's optiboot.
+ * - Only an external reset (the auto-reset when the port opens) enters the bootloader, any
+ *   other reset starts the application. Without a command for 1 s the watchdog resets into it.
+ * - Commands, one byte each followed by their arguments:
+ *     'S'                sync, replies 'A' 'L' <version>
+ *     'P' <page> <rle>   program a 128-byte page, replies '+' (written), '=' (unchanged) or
+ *                        '!' (page inside the boot section, not written)
+ *     'C' <pages>        CRC-16 (CCITT, 0xFFFF start) of the first pages (0 = all), 2 bytes LE
+ *     'G'                replies 'G' and starts the application
+ * - Page data is run-length coded: c < 0x80 is followed by c + 1 literal bytes, c >= 0x80 by
+ *   one byte repeated c - 0x7E times. Tokens end exactly at the page boundary.
+ * - The reply to 'P' goes out as soon as the page write has started, the next page is
+ *   received while the flash is still being written. Pages equal to the flash are skipped.
+ * - No C runtime: no globals, the page buffer is at the start of SRAM.
+ */
+
+#include <avr/io.h>
+#include <avr/boot.h>
+#include <avr/pgmspace.h>
+#include <avr/wdt.h>
+#include <util/crc16.h>
+
+#ifndef BOOT_BAUD
+#define BOOT_BAUD 1000000UL
+#endif
+#define BOOT_UBRR ((F_CPU / 8 + BOOT_BAUD / 2) / BOOT_BAUD - 1)
+#define BOOT_VERSION 1
+// First byte of the boot section, pages from here on are never erased
+#define BOOT_START 0x7E00
+
+// Page buffer, RAM is not used for anything else
+#define boot_buffer ((uint8_t *)RAMSTART)
+
+int main() __attribute__((OS_main, section(".init9")));
+
+// Set the watchdog control register, a timed sequence
+static inline void __BootWatchdog__(uint8_t control) {
+    WDTCSR = (1 << WDCE) | (1 << WDE);
+    WDTCSR = control;
+}
+
+// Wait for a received byte, every byte keeps the bootloader alive
+static uint8_t __BootRead__() {
+    while (!(UCSR0A & (1 << RXC0)));
+    wdt_reset();
+    return UDR0;
+}
+
+static void __BootWrite__(uint8_t c) {
+    while (!(UCSR0A & (1 << UDRE0)));
+    UDR0 = c;
+}
+
+// Finish a running page write, the application section is readable again afterwards
+static inline void __BootFlashIdle__() {
+    boot_spm_busy_wait();
+    boot_rww_enable();
+}
+
+int main() {
+    asm volatile("clr __zero_reg__");
+
+    uint8_t reset = MCUSR;
+    MCUSR = 0;
+    if (!(reset & (1 << EXTRF))) {
+        __BootWatchdog__(0);
+        asm volatile("jmp 0");
+    }
+
+    // 1 s timeout, reset into the application
+    __BootWatchdog__((1 << WDE) | (1 << WDP2) | (1 << WDP1));
+    UCSR0A = (1 << U2X0);
+    UBRR0L = BOOT_UBRR;
+    UCSR0B = (1 << RXEN0) | (1 << TXEN0);
+
+    for (;;) {
+        uint8_t command = __BootRead__();
+
+        if (command == 'S') {
+            __BootWrite__('A');
+            __BootWrite__('L');
+            __BootWrite__(BOOT_VERSION);
+        } else if (command == 'P') {
+            uint8_t page = __BootRead__();
+            uint16_t address = page * SPM_PAGESIZE;
+
+            // Decode the runs while the previous page is still being written
+            uint8_t *p = boot_buffer;
+            do {
+                uint8_t token = __BootRead__();
+                uint8_t run = token & 0x80;
+                uint8_t count = run ? token - 0x7E : token + 1;
+                uint8_t value = run ? __BootRead__() : 0;
+                do {
+                    *p++ = run ? value : __BootRead__();
+                } while (--count);
+            } while (p < boot_buffer + SPM_PAGESIZE);
+
+            // The data is still read in full so the stream stays in sync
+            if (page >= BOOT_START / SPM_PAGESIZE) {
+                __BootWrite__('!');
+                continue;
+            }
+
+            __BootFlashIdle__();
+            uint8_t same = 1;
+            for (uint8_t i = 0; i < SPM_PAGESIZE; i++)
+                if (pgm_read_byte(address + i) != boot_buffer[i])
+                    same = 0;
+
+            if (!same) {
+                boot_page_erase(address);
+                boot_spm_busy_wait();
+                for (uint8_t i = 0; i < SPM_PAGESIZE; i += 2)
+                    boot_page_fill(address + i, boot_buffer[i] | boot_buffer[i + 1] << 8);
+                // Not waited for, the next command waits only if it needs the flash
+                boot_page_write(address);
+            }
+            __BootWrite__(same ? '=' : '+');
+        } else if (command == 'C') {
+            uint8_t pages = __BootRead__();
+            uint16_t end = (pages ? pages : 256) * SPM_PAGESIZE;
+            uint16_t crc = 0xFFFF;
+
+            __BootFlashIdle__();
+            for (uint16_t a = 0; a != end; a++)
+                crc = _crc_ccitt_update(crc, pgm_read_byte(a));
+            __BootWrite__(crc & 0xFF);
+            __BootWrite__(crc >> 8);
+        } else if (command == 'G') {
+            __BootFlashIdle__();
+            __BootWrite__('G');
+            // Reset through the watchdog in 15 ms, the application starts with clean registers
+            __BootWatchdog__(1 << WDE);
+            for (;;);
+        }
+    }
+}
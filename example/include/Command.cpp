@@ -0,0 +1,228 @@
+#include "Command.h"
+#include "RingBuffer.h"
+
+#if AVRLITE_USE_COMMAND
+
+// Received bytes, filled by USART_RX_vect and drained by Command_poll
+static RingBuffer<uint8_t, COMMAND_RX_BUFFER_SIZE> command_rx;
+static volatile unsigned long command_overruns;
+
+// Line being collected, tokens point into it while the handler runs
+static char command_line[COMMAND_LINE_SIZE];
+static uint8_t command_length;
+static uint8_t command_discard;
+
+static const Command_Table *command_table;
+static uint8_t command_flags;
+
+// Interrupt Service Routine (ISR) for USART receive complete, about 40 cycles
+ISR(USART_RX_vect) {
+    uint8_t c = UDR0;
+    if (!command_rx.push(c))
+        command_overruns++;
+}
+
+// Take commands from Serial (after Serial_begin) with a generated table, enables the receive interrupt
+void Command_begin(const Command_Table *table, uint8_t flags) {
+    command_table = table;
+    command_flags = flags;
+    command_length = 0;
+    command_discard = 0;
+
+    uint8_t oldSREG = SREG;
+    cli();
+    UCSR0B |= (1 << RXCIE0);
+    SREG = oldSREG;
+}
+
+// Pass a result through, answering rejected lines unless COMMAND_QUIET
+static uint8_t __CommandReport__(uint8_t result) {
+    if (command_flags & COMMAND_QUIET)
+        return result;
+
+    if (result == COMMAND_UNKNOWN)
+        Serial_println_P(PSTR("ERR unknown"));
+    else if (result == COMMAND_BAD_ARGS)
+        Serial_println_P(PSTR("ERR args"));
+    else if (result == COMMAND_TOO_LONG)
+        Serial_println_P(PSTR("ERR too long"));
+    return result;
+}
+
+// Next space-separated or "quoted" token, terminated in place, NULL at the end of the line
+static char *__CommandToken__(char **cursor) {
+    char *p = *cursor;
+    while (*p == ' ' || *p == '\t')
+        p++;
+    if (*p == '\0')
+        return NULL;
+
+    char *token = p;
+    if (*p == '"') {
+        token = ++p;
+        while (*p && *p != '"')
+            p++;
+    } else {
+        while (*p && *p != ' ' && *p != '\t')
+            p++;
+    }
+    if (*p)
+        *p++ = '\0';
+    *cursor = p;
+    return token;
+}
+
+// Parse an unsigned decimal or 0x hex number, returns 0 on junk or overflow
+static uint8_t __CommandParseUnsigned__(const char *text, uint32_t *value) {
+    uint8_t base = 10;
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        base = 16;
+        text += 2;
+    }
+    if (*text == '\0')
+        return 0;
+
+    uint32_t result = 0;
+    for (; *text; text++) {
+        uint8_t digit;
+        char c = *text;
+        if (c >= '0' && c <= '9')
+            digit = c - '0';
+        else if (base == 16 && (c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+            digit = (c | 0x20) - 'a' + 10;
+        else
+            return 0;
+        if (result > (UINT32_MAX - digit) / base)
+            return 0;
+        result = result * base + digit;
+    }
+    *value = result;
+    return 1;
+}
+
+// Parse a decimal fraction into Q16.16, up to 4 fraction digits are used
+static uint8_t __CommandParseFixed__(const char *text, int32_t *value) {
+    uint8_t negative = (*text == '-');
+    if (negative)
+        text++;
+
+    uint32_t whole = 0, fraction = 0, scale = 1;
+    uint8_t digits = 0;
+    for (; *text >= '0' && *text <= '9'; text++, digits++) {
+        whole = whole * 10 + (*text - '0');
+        if (whole > 32767)
+            return 0;
+    }
+    if (*text == '.') {
+        for (text++; *text >= '0' && *text <= '9'; text++, digits++) {
+            if (scale < 10000) {
+                fraction = fraction * 10 + (*text - '0');
+                scale *= 10;
+            }
+        }
+    }
+    if (*text != '\0' || digits == 0)
+        return 0;
+
+    int32_t result = (int32_t)(whole << 16) + (int32_t)(((fraction << 16) + scale / 2) / scale);
+    *value = negative ? -result : result;
+    return 1;
+}
+
+// Convert a token to the type of a signature letter
+static uint8_t __CommandParse__(char type, char *token, Command_Arg *arg) {
+    switch (type) {
+        case 'u':
+            return __CommandParseUnsigned__(token, &arg->u);
+        case 'i': {
+            uint8_t negative = (*token == '-');
+            uint32_t magnitude;
+            if (!__CommandParseUnsigned__(token + negative, &magnitude))
+                return 0;
+            if (magnitude > (negative ? 0x80000000UL : 0x7FFFFFFFUL))
+                return 0;
+            arg->i = negative ? (int32_t)(0 - magnitude) : (int32_t)magnitude;
+            return 1;
+        }
+        case 'q':
+            return __CommandParseFixed__(token, &arg->q);
+        case 's':
+            arg->s = token;
+            return 1;
+    }
+    return 0;
+}
+
+// Tokenize and run one line in place (the line is modified), e.g. from another transport
+uint8_t Command_execute(char *line) {
+    char *cursor = line;
+    char *name = __CommandToken__(&cursor);
+    if (name == NULL)
+        return COMMAND_IDLE;
+    if (command_table == NULL)
+        return __CommandReport__(COMMAND_UNKNOWN);
+
+    // The only slot the name can be in
+    const Command_Entry *entry = &command_table->slots[__CommandSlot__(command_table, name)];
+    PGM_P entryName = (PGM_P)pgm_read_ptr(&entry->name);
+    if (entryName == NULL || strcmp_P(name, entryName) != 0)
+        return __CommandReport__(COMMAND_UNKNOWN);
+
+    // Arguments are parsed straight from the line, strings stay in it
+    Command_Arg args[COMMAND_MAX_ARGS];
+    PGM_P signature = (PGM_P)pgm_read_ptr(&entry->signature);
+    uint8_t count = 0;
+    char type;
+    while ((type = pgm_read_byte(signature++))) {
+        char *token = __CommandToken__(&cursor);
+        if (token == NULL || count == COMMAND_MAX_ARGS || !__CommandParse__(type, token, &args[count]))
+            return __CommandReport__(COMMAND_BAD_ARGS);
+        count++;
+    }
+    if (__CommandToken__(&cursor) != NULL)
+        return __CommandReport__(COMMAND_BAD_ARGS);
+
+    Command_Handler handler = (Command_Handler)pgm_read_ptr(&entry->handler);
+    handler(args);
+    return COMMAND_OK;
+}
+
+// Collect received bytes and run at most one complete line, call it from the main loop
+uint8_t Command_poll() {
+    for (uint8_t n = 0; n < COMMAND_POLL_BYTES; n++) {
+        uint8_t c;
+        if (!command_rx.pop(c))
+            return COMMAND_IDLE;
+
+        if (c == '\r' || c == '\n') {
+            uint8_t length = command_length;
+            command_length = 0;
+            if (command_discard) {
+                command_discard = 0;
+                return __CommandReport__(COMMAND_TOO_LONG);
+            }
+            // Blank line, or the second half of "\r\n"
+            if (length == 0)
+                continue;
+            command_line[length] = '\0';
+            return Command_execute(command_line);
+        }
+
+        if (command_length < COMMAND_LINE_SIZE - 1)
+            command_line[command_length++] = c;
+        else
+            command_discard = 1;
+    }
+    return COMMAND_IDLE;
+}
+
+// Number of received bytes lost because the receive buffer was full
+unsigned long Command_overruns() {
+    uint8_t oldSREG = SREG;
+    cli();
+    unsigned long overruns = command_overruns;
+    SREG = oldSREG;
+    return overruns;
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef Command_h
+#define Command_h
+
+#include "AVRLite.h"
+
+// Receive buffer filled by the USART receive interrupt (power of two, at most 128)
+#ifndef COMMAND_RX_BUFFER_SIZE
+#define COMMAND_RX_BUFFER_SIZE 32
+#endif
+
+// Longest command line in bytes, including the terminator
+#ifndef COMMAND_LINE_SIZE
+#define COMMAND_LINE_SIZE 48
+#endif
+
+// Most arguments of one command
+#ifndef COMMAND_MAX_ARGS
+#define COMMAND_MAX_ARGS 4
+#endif
+
+// Received bytes Command_poll moves into the line per call, bounds the time of a call
+#ifndef COMMAND_POLL_BYTES
+#define COMMAND_POLL_BYTES 16
+#endif
+
+// Result of Command_poll and Command_execute
+#define COMMAND_IDLE     0x0  // No complete line yet (or an empty line)
+#define COMMAND_OK       0x1  // The handler ran
+#define COMMAND_UNKNOWN  0x2  // No command of that name
+#define COMMAND_BAD_ARGS 0x3  // Wrong number of arguments or a value that does not parse
+#define COMMAND_TOO_LONG 0x4  // Line longer than COMMAND_LINE_SIZE, dropped
+
+// Command_begin flags
+#define COMMAND_REPORT   0x0  // Answer rejected lines with "ERR <reason>"
+#define COMMAND_QUIET    0x1  // Only return the result
+
+// Parsed argument, its type is the matching letter of the command's signature
+typedef union {
+    int32_t i;       // 'i': signed decimal or 0x hex
+    uint32_t u;      // 'u': unsigned decimal or 0x hex
+    int32_t q;       // 'q': decimal fraction as Q16.16 (FixedPoint.h), e.g. -1.25
+    const char *s;   // 's': word or "quoted text", points into the line buffer
+} Command_Arg;
+
+// Command handler, one argument per signature letter
+typedef void (*Command_Handler)(const Command_Arg *args);
+
+// Table slot in flash, an empty slot has no name
+typedef struct {
+    PGM_P name;
+    PGM_P signature;
+    Command_Handler handler;
+} Command_Entry;
+
+// Perfect-hash command table written by tools/command_table.py (hash and displace): the name
+// hash picks a bucket, the bucket's displacement picks the one slot the name can be in, so a
+// lookup is one hash, one flash byte and one string compare.
+typedef struct {
+    uint8_t seed;
+    uint8_t mask;                  // Slots - 1
+    uint8_t bucketMask;            // Buckets - 1
+    const uint8_t *displacement;   // PROGMEM, one byte per bucket
+    const Command_Entry *slots;    // PROGMEM, mask + 1 entries
+} Command_Table;
+
+// Table hash of a name (mirrored by the generator)
+static inline uint16_t __CommandHash__(uint8_t seed, const char *name) {
+    uint16_t h = seed;
+    while (*name)
+        h = (uint16_t)((uint16_t)(h ^ (uint8_t)*name++) * 0x9E37U);
+    return h ^ (h >> 8);
+}
+
+// Slot of a name: (h >> 8) + d * ((h >> 4) | 1), with d the displacement of bucket h & bucketMask
+static inline uint8_t __CommandSlot__(const Command_Table *table, const char *name) {
+    uint16_t h = __CommandHash__(table->seed, name);
+    uint8_t d = pgm_read_byte(&table->displacement[h & table->bucketMask]);
+    return (uint8_t)((uint8_t)(h >> 8) + d * (uint8_t)((h >> 4) | 1)) & table->mask;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Take commands from Serial (after Serial_begin) with a generated table, enables the receive interrupt
+void Command_begin(const Command_Table *table, uint8_t flags);
+
+// Collect received bytes and run at most one complete line, call it from the main loop
+uint8_t Command_poll();
+
+// Tokenize and run one line in place (the line is modified), e.g. from another transport
+uint8_t Command_execute(char *line);
+
+// Number of received bytes lost because the receive buffer was full
+unsigned long Command_overruns();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,223 @@
+#include "Comparator.h"
+#include "Power.h"
+
+#if AVRLITE_USE_COMPARATOR
+
+#if !AVRLITE_USE_ICP
+#error "Comparator.h needs AVRLITE_USE_ICP for its Timer1 time base"
+#endif
+
+static volatile Comparator_Callback comparator_callback;
+static uint8_t comparator_mode;
+static uint8_t comparator_negative;
+static uint8_t comparator_active;
+
+// Edge filtering and software timestamps (without COMPARATOR_CAPTURE)
+static unsigned long comparator_holdoff;
+static unsigned long comparator_last_accepted;
+static unsigned long comparator_last_edge;
+static uint8_t comparator_referenced;
+static volatile unsigned long comparator_period;
+static volatile unsigned long comparator_edges;
+
+// Interrupt Service Routine (ISR) for the analog comparator, timestamps and filters edges
+ISR(ANALOG_COMP_vect) {
+    unsigned long now = ICP_now();
+    uint8_t level = (ACSR >> ACO) & 1;
+
+    if (comparator_edges && now - comparator_last_accepted < comparator_holdoff)
+        return;
+    comparator_last_accepted = now;
+
+    // Periods between rising edges in toggle mode, between every edge otherwise
+    if (!(comparator_mode & COMPARATOR_CAPTURE) &&
+        ((comparator_mode & COMPARATOR_RISING) != COMPARATOR_TOGGLE || level)) {
+        if (comparator_referenced)
+            comparator_period = now - comparator_last_edge;
+        comparator_last_edge = now;
+        comparator_referenced = 1;
+    }
+    comparator_edges++;
+
+    Comparator_Callback callback = comparator_callback;
+    if (callback)
+        callback(level);
+}
+
+// Enable the comparator interrupt if it has work, the pending flag is cleared first
+static void __ComparatorInterrupt__() {
+    uint8_t oldSREG = SREG;
+    cli();
+    if (comparator_active && (!(comparator_mode & COMPARATOR_CAPTURE) || comparator_callback)) {
+        ACSR |= (1 << ACI);
+        ACSR |= (1 << ACIE);
+    } else {
+        ACSR &= ~(1 << ACIE);
+    }
+    SREG = oldSREG;
+}
+
+// Compare positive against negative and timestamp the selected edges
+uint8_t Comparator_begin(uint8_t positive, uint8_t negative, uint8_t mode) {
+    if (positive != D6 && positive != COMPARATOR_BANDGAP)
+        return 0;
+    if (negative != D7 && (negative < A0 || negative > A5))
+        return 0;
+    // ACIS1:0 = 1 is reserved
+    if ((mode & COMPARATOR_RISING) == 1)
+        return 0;
+
+    // The interrupt has to be off while ACD and ACIS change
+    ACSR &= ~(1 << ACIE);
+    comparator_active = 0;
+
+    if (negative == D7) {
+        if (Power_enabled() & POWER_ADC)
+            ADCSRB &= ~(1 << ACME);
+        DIDR1 |= (1 << AIN1D);
+    } else {
+        // The multiplexer needs the ADC powered but not enabled
+        Power_enable(POWER_ADC);
+        ADCSRA &= ~(1 << ADEN);
+        ADMUX = (ADMUX & 0xF0) | (negative - A0);
+        ADCSRB |= (1 << ACME);
+        DIDR0 |= (1 << (negative - A0));
+    }
+    if (positive == D6)
+        DIDR1 |= (1 << AIN0D);
+
+    uint8_t acsr = mode & COMPARATOR_RISING;
+    if (positive == COMPARATOR_BANDGAP)
+        acsr |= (1 << ACBG);
+    if (mode & COMPARATOR_CAPTURE)
+        acsr |= (1 << ACIC);
+    ACSR = acsr;
+    // The bandgap takes up to 70 us to settle after it is selected
+    if (positive == COMPARATOR_BANDGAP)
+        _delay_us(70);
+
+    uint8_t oldSREG = SREG;
+    cli();
+    comparator_mode = mode;
+    comparator_negative = negative;
+    comparator_referenced = 0;
+    comparator_last_accepted = comparator_last_edge = 0;
+    comparator_period = 0;
+    comparator_edges = 0;
+    comparator_active = 1;
+    SREG = oldSREG;
+
+    if (mode & COMPARATOR_CAPTURE) {
+        // Toggle captures alternate edges, which still gives the period between rising edges
+        uint8_t edge = (mode & COMPARATOR_RISING) == COMPARATOR_RISING ? ICP_RISING
+                     : (mode & COMPARATOR_RISING) == COMPARATOR_FALLING ? ICP_FALLING : ICP_BOTH;
+        ICP_begin(edge | ((mode & COMPARATOR_NOISE_CANCEL) ? ICP_NOISE_CANCEL : 0));
+    } else {
+        __ICPTimebase__(ICP_TIMEBASE_COMPARATOR);
+    }
+    __ComparatorInterrupt__();
+    // Edges are timestamped in ANALOG_COMP_vect
+    sei();
+    return 1;
+}
+
+// Switch the comparator off (ACD) and release its inputs
+void Comparator_end() {
+    ACSR &= ~(1 << ACIE);
+    if (comparator_active) {
+        // Timer1 keeps counting overflows while ICP_begin is still in use elsewhere
+        if (comparator_mode & COMPARATOR_CAPTURE)
+            ICP_end();
+        else
+            __ICPTimebaseRelease__(ICP_TIMEBASE_COMPARATOR);
+        if (comparator_negative != D7 && (Power_enabled() & POWER_ADC)) {
+            ADCSRB &= ~(1 << ACME);
+            DIDR0 &= ~(1 << (comparator_negative - A0));
+        }
+        DIDR1 &= ~((1 << AIN1D) | (1 << AIN0D));
+        comparator_active = 0;
+    }
+    ACSR = (1 << ACD) | (1 << ACI);
+}
+
+// Current output level, 1 while positive > negative
+uint8_t Comparator_read() {
+    return (ACSR >> ACO) & 1;
+}
+
+// Call back on every accepted edge, NULL to stop
+void Comparator_onEdge(Comparator_Callback callback) {
+    comparator_callback = callback;
+    __ComparatorInterrupt__();
+}
+
+// Ignore edges closer than counts Timer1 counts to the previous one
+void Comparator_setHoldoff(unsigned long counts) {
+    uint8_t oldSREG = SREG;
+    cli();
+    comparator_holdoff = counts;
+    SREG = oldSREG;
+}
+
+// Accepted edges since Comparator_begin
+unsigned long Comparator_edges() {
+    uint8_t oldSREG = SREG;
+    cli();
+    unsigned long edges = comparator_edges;
+    SREG = oldSREG;
+    return edges;
+}
+
+// Latest period between selected edges, in Timer1 counts
+unsigned long Comparator_period() {
+    if (comparator_mode & COMPARATOR_CAPTURE)
+        return ICP_period();
+    uint8_t oldSREG = SREG;
+    cli();
+    unsigned long period = comparator_period;
+    SREG = oldSREG;
+    return period;
+}
+
+// Timestamp of the latest edge that started a period, in Timer1 counts
+unsigned long Comparator_lastEdge() {
+    if (comparator_mode & COMPARATOR_CAPTURE)
+        return ICP_lastEdge();
+    uint8_t oldSREG = SREG;
+    cli();
+    unsigned long edge = comparator_last_edge;
+    SREG = oldSREG;
+    return edge;
+}
+
+// Frequency from the latest period in hundredths of Hz
+unsigned long Comparator_frequency() {
+    unsigned long period = Comparator_period();
+    if (period == 0)
+        return 0;
+    return (F_CPU * 100UL + period / 2) / period;
+}
+
+// Phase of a Timer1 timestamp within the current period, 65536 = one full cycle
+uint16_t Comparator_phase(unsigned long timestamp) {
+    unsigned long period = Comparator_period();
+    if (period == 0)
+        return 0;
+    unsigned long last = Comparator_lastEdge();
+
+    // Timestamps before the latest edge count back from it
+    unsigned long elapsed;
+    if ((long)(timestamp - last) >= 0)
+        elapsed = (timestamp - last) % period;
+    else
+        elapsed = (period - (last - timestamp) % period) % period;
+
+    // Scale the period into 16 bits so the division stays in 32 bits
+    while (period > 0xFFFF) {
+        period >>= 1;
+        elapsed >>= 1;
+    }
+    return (uint16_t)((elapsed << 16) / period);
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef EEPROM_h
+#define EEPROM_h
+
+#include "AVRLite.h"
+
+// Number of cached bytes (pending writes plus recently read bytes), at most 128
+#ifndef EEPROM_CACHE_SIZE
+#define EEPROM_CACHE_SIZE 16
+#endif
+
+// Wear-leveled ring of fixed-size records, see EEPROM_ringBegin
+typedef struct {
+    uint16_t base;    // First EEPROM address used by the ring
+    uint8_t slots;    // Number of records in the ring (2-255)
+    uint8_t size;     // Record size in bytes
+    uint8_t index;    // Slot holding the latest record
+} EEPROM_Ring;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Read a byte, served from the cache when possible
+uint8_t EEPROM_read(uint16_t address);
+// Queue a byte write and return immediately, unchanged bytes are skipped
+void EEPROM_write(uint16_t address, uint8_t value);
+// Block versions of EEPROM_read and EEPROM_write
+void EEPROM_readBlock(uint16_t address, void *data, uint16_t length);
+void EEPROM_writeBlock(uint16_t address, const void *data, uint16_t length);
+
+// Number of writes still waiting for the EEPROM
+uint8_t EEPROM_pending();
+// Wait until every queued write has reached the EEPROM
+void EEPROM_flush();
+// Number of bytes physically written and skipped as unchanged since startup
+unsigned long EEPROM_writes();
+unsigned long EEPROM_skipped();
+
+// Set up a ring of `slots` records of `size` bytes at `base`, it uses slots * (size + 1) bytes
+void EEPROM_ringBegin(EEPROM_Ring *ring, uint16_t base, uint8_t slots, uint8_t size);
+// Read the latest record
+void EEPROM_ringRead(EEPROM_Ring *ring, void *data);
+// Store a new record in the next slot, spreading wear across the ring
+void EEPROM_ringWrite(EEPROM_Ring *ring, const void *data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,198 @@
+#include "FixedPoint.h"
+#include "AVRLiteConfig.h"
+#include <avr/pgmspace.h>
+
+#if AVRLITE_USE_FIXEDPOINT
+
+// sin(i * 90 / 64 degrees) in Q1.15, i = 0..64
+static const int16_t sine_table[65] PROGMEM = {
+         0,    804,   1608,   2411,   3212,   4011,   4808,   5602,
+      6393,   7180,   7962,   8740,   9512,  10279,  11039,  11793,
+     12540,  13279,  14010,  14733,  15447,  16151,  16846,  17531,
+     18205,  18868,  19520,  20160,  20788,  21403,  22006,  22595,
+     23170,  23732,  24279,  24812,  25330,  25833,  26320,  26791,
+     27246,  27684,  28106,  28511,  28899,  29269,  29622,  29957,
+     30274,  30572,  30853,  31114,  31357,  31581,  31786,  31972,
+     32138,  32286,  32413,  32522,  32610,  32679,  32729,  32758,
+     32767
+};
+
+// atan(i / 32) as a binary angle, i = 0..32
+static const uint16_t atan_table[33] PROGMEM = {
+         0,    326,    651,    975,   1297,   1617,   1933,   2246,
+      2555,   2860,   3159,   3453,   3742,   4025,   4302,   4572,
+      4836,   5094,   5344,   5589,   5826,   6058,   6282,   6500,
+      6712,   6917,   7117,   7310,   7498,   7679,   7856,   8026,
+      8192
+};
+
+// 255 * (i / 255)^2.2
+static const uint8_t gamma8_table[256] PROGMEM = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+     42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+     91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255
+};
+
+// 65535 * (i / 64)^2.2, i = 0..64
+static const uint16_t gamma16_table[65] PROGMEM = {
+         0,      7,     32,     78,    147,    240,    359,    504,
+       676,    875,   1104,   1361,   1648,   1966,   2314,   2693,
+      3104,   3547,   4022,   4530,   5072,   5646,   6255,   6897,
+      7574,   8286,   9033,   9815,  10632,  11486,  12375,  13301,
+     14263,  15262,  16298,  17371,  18482,  19630,  20816,  22040,
+     23303,  24604,  25943,  27322,  28739,  30196,  31692,  33227,
+     34802,  36417,  38072,  39768,  41503,  43280,  45097,  46954,
+     48853,  50793,  52774,  54796,  56860,  58966,  61114,  63303,
+     65535
+};
+
+// Sine of the first quadrant: 6 bits table index, 8 bits interpolation
+static int16_t __sineQuadrant__(uint16_t angle) {
+    uint8_t index = angle >> 8;
+    uint8_t fraction = angle & 0xFF;
+    int16_t a = pgm_read_word(&sine_table[index]);
+    int16_t b = pgm_read_word(&sine_table[index + 1]);
+    return a + (((int32_t)(b - a) * fraction) >> 8);
+}
+
+// Sine of a binary angle as Q1.15
+q1_15_t Q1_15_sin(uint16_t angle) {
+    uint16_t offset = angle & (ANGLE_90 - 1);
+    int16_t value;
+
+    // Mirror the quarter wave into the other quadrants
+    if (angle & ANGLE_90)
+        value = offset ? __sineQuadrant__(ANGLE_90 - offset) : INT16_MAX;
+    else
+        value = __sineQuadrant__(offset);
+
+    return (angle & ANGLE_180) ? -value : value;
+}
+
+// Cosine of a binary angle as Q1.15
+q1_15_t Q1_15_cos(uint16_t angle) {
+    return Q1_15_sin(angle + ANGLE_90);
+}
+
+// Angle of the vector (x, y) as a binary angle
+uint16_t atan2Angle(int16_t y, int16_t x) {
+    if (x == 0 && y == 0)
+        return 0;
+
+    // Fold into the first octant: 0 <= ratio = small / large <= 1
+    uint16_t ax = x < 0 ? -(int32_t)x : x;
+    uint16_t ay = y < 0 ? -(int32_t)y : y;
+    uint8_t swap = ay > ax;
+    uint16_t small = swap ? ax : ay, large = swap ? ay : ax;
+
+    // Ratio with 13 bits: 5 bits table index, 8 bits interpolation
+    uint16_t ratio = ((uint32_t)small << 13) / large;
+    uint8_t index = ratio >> 8;
+    uint8_t fraction = ratio & 0xFF;
+    uint16_t a = pgm_read_word(&atan_table[index]);
+    uint16_t angle = a;
+    if (index < 32) {
+        uint16_t b = pgm_read_word(&atan_table[index + 1]);
+        angle += ((uint32_t)(b - a) * fraction) >> 8;
+    }
+
+    // Unfold into the right octant and quadrant
+    if (swap)
+        angle = ANGLE_90 - angle;
+    if (x < 0)
+        angle = ANGLE_180 - angle;
+    if (y < 0)
+        angle = -angle;
+    return angle;
+}
+
+// Integer square root of a 16-bit value, rounded down
+uint8_t isqrt16(uint16_t value) {
+    uint8_t root = 0;
+    for (uint8_t bit = 0x80; bit; bit >>= 1) {
+        uint8_t trial = root | bit;
+        if ((uint16_t)trial * trial <= value)
+            root = trial;
+    }
+    return root;
+}
+
+// Integer square root of a 32-bit value, rounded down (shift-subtract, no multiplications)
+uint16_t isqrt32(uint32_t value) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > value)
+        bit >>= 2;
+    while (bit) {
+        if (value >= root + bit) {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+// Gamma 2.2 correction of an 8-bit brightness
+uint8_t gamma8(uint8_t value) {
+    return pgm_read_byte(&gamma8_table[value]);
+}
+
+// Gamma 2.2 correction of a 16-bit brightness: 6 bits table index, 10 bits interpolation
+uint16_t gamma16(uint16_t value) {
+    uint8_t index = value >> 10;
+    uint16_t fraction = value & 0x3FF;
+    fraction += fraction >> 9;  // Stretch 0..1023 to 0..1024 so 0xFFFF maps to the last entry
+    uint16_t a = pgm_read_word(&gamma16_table[index]);
+    uint16_t b = pgm_read_word(&gamma16_table[index + 1]);
+    return a + (((uint32_t)(b - a) * fraction) >> 10);
+}
+
+// First-order IIR filter, weight 1 / 2^shift for the newest sample
+void IIR_begin(IIR_Filter *filter, uint8_t shift, int16_t initial) {
+    filter->shift = shift;
+    filter->state = (int32_t)initial << shift;
+}
+
+int16_t IIR_update(IIR_Filter *filter, int16_t sample) {
+    // state += sample - state / 2^shift, only shifts and adds
+    filter->state += sample - (filter->state >> filter->shift);
+    return filter->state >> filter->shift;
+}
+
+// Moving average over `size` samples kept in `window`
+void MovingAverage_begin(MovingAverage *filter, int16_t *window, uint8_t size) {
+    filter->window = window;
+    filter->size = size;
+    filter->index = 0;
+    filter->sum = 0;
+    for (uint8_t i = 0; i < size; i++)
+        window[i] = 0;
+}
+
+int16_t MovingAverage_update(MovingAverage *filter, int16_t sample) {
+    // Running sum: drop the oldest sample, add the newest
+    filter->sum += sample - filter->window[filter->index];
+    filter->window[filter->index] = sample;
+    if (++filter->index == filter->size)
+        filter->index = 0;
+    return filter->sum / filter->size;
+}
+
+#endif
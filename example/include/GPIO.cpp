@@ -0,0 +1,195 @@
+#include "AVRLite.h"
+#include "Trace.h"
+#include "Power.h"
+
+// Configure pin mode (INPUT or OUTPUT)
+int GPIOInit(uint8_t pin, uint8_t mode) {
+    TRACE_RECORD(TRACE_MODE, pin, mode == OUTPUT);
+    if (mode == OUTPUT) {
+        if (pin >= 0 && pin <= 7)        DDRD |= (1 << pin);
+        else if (pin >= 8 && pin <= 13)  DDRB |= (1 << (pin - 8));
+        else if (pin >= 14 && pin <= 19) DDRC |= (1 << (pin - 14));
+        
+        return 1;
+    } 
+    else {
+        if (pin >= 0 && pin <= 7)        DDRD &= ~(1 << pin);
+        else if (pin >= 8 && pin <= 13)  DDRB &= ~(1 << (pin - 8));
+        else if (pin >= 14 && pin <= 19) DDRC &= ~(1 << (pin - 14));
+
+        return 1;
+    }
+
+    return 0;
+}
+
+// Write to a digital pin
+void __GPIODigitalWrite__(uint8_t pin, uint8_t mode) {
+    if (mode == HIGH) {
+        if (pin >= 0 && pin <= 7)        PORTD |= (1 << pin);
+        else if (pin >= 8 && pin <= 13)  PORTB |= (1 << (pin - 8));
+        else if (pin >= 14 && pin <= 19) PORTC |= (1 << (pin - 14));
+    } 
+    else if (mode == LOW) {
+        if (pin >= 0 && pin <= 7)        PORTD &= ~(1 << pin);
+        else if (pin >= 8 && pin <= 13)  PORTB &= ~(1 << (pin - 8));
+        else if (pin >= 14 && pin <= 19) PORTC &= ~(1 << (pin - 14));
+    }
+}
+
+// Duty cycles of D9 and D10, 0 = off
+static volatile uint8_t gpio_pwm_duty[2];
+
+// Interrupt Service Routine (ISR) for Timer1 compare B: software PWM on D9/D10 (OC1A/OC1B), one
+// 256-step cycle per Timer1 wrap (244 Hz at 16 MHz). Edges lag by the interrupt latency.
+ISR(TIMER1_COMPB_vect) {
+    uint8_t step = OCR1B >> 8;
+    uint8_t next = 0;
+    for (uint8_t i = 0; i < 2; i++) {
+        uint8_t duty = gpio_pwm_duty[i];
+        uint8_t mask = (1 << PB1) << i;
+        if (duty == 0)
+            continue;
+        if (step == 0)
+            PORTB |= mask;
+        // 255 stays on for the whole cycle
+        if (duty == 255)
+            continue;
+        if (duty <= step)
+            PORTB &= ~mask;
+        else if (next == 0 || duty < next)
+            next = duty;
+    }
+    // The next edge, or the start of the next cycle
+    OCR1B = (uint16_t)next << 8;
+}
+
+// Handle analogWrite (PWM output)
+void __GPIOAnalogWrite__(uint8_t pin, uint8_t value) {
+    if (pin == D3 || pin == D11) {
+        if (value)
+            Power_enable(POWER_TIMER2);
+        if (pin == D3) {
+            if (value == 0) {
+                TCCR2A &= ~(1 << COM2B1); // Non-PWM mode
+                OCR2B = 0; // Set duty cycle to 0
+            } else {
+                TCCR2A |= (1 << COM2B1) | (1 << WGM20) | (1 << WGM21); // Fast PWM, clear on compare match
+                TCCR2B |= (1 << CS21); // Prescaler 8
+                OCR2B = value; // Set duty cycle
+            }
+        } 
+        else if (pin == D11) {
+            if (value == 0) {
+                TCCR2A &= ~(1 << COM2A1); // Non-PWM mode
+                OCR2A = 0; // Set duty cycle to 0
+            } else {
+                TCCR2A |= (1 << COM2A1) | (1 << WGM20) | (1 << WGM21); // Fast PWM, clear on compare match
+                TCCR2B |= (1 << CS21); // Prescaler 8
+                OCR2A = value; // Set duty cycle
+            }
+        }
+    } 
+    else if (pin == D5 || pin == D6) {
+        Power_enable(POWER_TIMER0);
+        if (pin == D5) {
+            if (value == 0) {
+                TCCR0A &= ~(1 << COM0B1); // Non-PWM mode
+                OCR0B = 0; // Set duty cycle to 0
+            } else {
+                TCCR0A |= (1 << COM0B1) | (1 << WGM00) | (1 << WGM01); // Fast PWM, clear on compare match
+                TCCR0B |= (1 << CS01); // Prescaler 8
+                OCR0B = value; // Set duty cycle
+            }
+        } 
+        else if (pin == D6) {
+            if (value == 0) {
+                TCCR0A &= ~(1 << COM0A1); // Non-PWM mode
+                OCR0A = 0; // Set duty cycle to 0
+            } else {
+                TCCR0A |= (1 << COM0A1) | (1 << WGM00) | (1 << WGM01); // Fast PWM, clear on compare match
+                TCCR0B |= (1 << CS01); // Prescaler 8
+                OCR0A = value; // Set duty cycle
+            }
+        }
+    }
+    else if (pin == D9 || pin == D10) {
+        // Timer1 runs free for timekeeping, so its pins are switched from the compare B interrupt
+        uint8_t mask = (pin == D9) ? (1 << PB1) : (1 << PB2);
+        __TimeBegin__();
+
+        uint8_t oldSREG = SREG;
+        cli();
+        gpio_pwm_duty[pin - D9] = value;
+        if (value == 0)
+            PORTB &= ~mask;
+        if (gpio_pwm_duty[0] == 0 && gpio_pwm_duty[1] == 0) {
+            TIMSK1 &= ~(1 << OCIE1B);
+        } else if (!(TIMSK1 & (1 << OCIE1B))) {
+            // First cycle starts at the next Timer1 wrap
+            OCR1B = 0;
+            TIFR1 = (1 << OCF1B);
+            TIMSK1 |= (1 << OCIE1B);
+        }
+        SREG = oldSREG;
+    }
+}
+
+uint8_t GPIOWrite(uint8_t pin, uint8_t mode, uint8_t value) {
+    if (mode == ANALOGWRITE) {
+        TRACE_RECORD(TRACE_PWM, pin, value);
+        __GPIOAnalogWrite__(pin, value);
+        return value;
+    }
+    if (mode == HIGH || mode == LOW) {
+        TRACE_RECORD(TRACE_WRITE, pin, mode);
+        __GPIODigitalWrite__(pin, mode);
+        return mode;
+    }
+
+    return 0;
+}
+
+// Overloaded versions of GPIOControl for DIGITALREAD and ANALOGREAD without mode parameter
+int GPIORead(uint8_t pin, uint8_t state) {
+    if (state == DIGITALREAD) {
+        if (pin >= 0 && pin <= 7) 
+            return (PIND & (1 << pin)) ? HIGH : LOW;
+        else if (pin >= 8 && pin <= 13)
+            return (PINB & (1 << (pin - 8))) ? HIGH : LOW;
+        else if (pin >= 14 && pin <= 19)
+            return (PINC & (1 << (pin - 14))) ? HIGH : LOW;
+
+        return LOW;
+    }
+    if (state == ANALOGREAD) {
+        if (pin >= A0 && pin <= A5) {
+            // The comparator owns the multiplexer (ACME with ADEN off), enabling the ADC would detach its input
+            if ((ADCSRB & (1 << ACME)) && !(ACSR & (1 << ACD)) && !(ADCSRA & (1 << ADEN)))
+                return -1;
+            // Power the ADC up on first use, 125 kHz conversion clock at 16 MHz (/128)
+            if (!(ADCSRA & (1 << ADEN))) {
+                Power_enable(POWER_ADC);
+                ADCSRA = (1 << ADEN) | (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
+            }
+            uint8_t adc_pin = pin - A0;
+            ADMUX = (1 << REFS0) | (adc_pin & 0x07);
+            ADCSRA |= (1 << ADSC);
+            while (ADCSRA & (1 << ADSC));
+            TRACE_RECORD(TRACE_ADC, pin, ADC);
+            return ADC;
+        }
+    }
+    
+    return LOW;
+}
+
+// Control GPIO states
+int GPIOControl(uint8_t pin, uint8_t mode, uint8_t value) {
+    if (mode == OUTPUT || mode == INPUT)
+        return GPIOInit(pin, mode);
+    if (mode == DIGITALREAD || mode == ANALOGREAD)
+        return GPIORead(pin, mode);
+    if (mode == HIGH || mode == LOW || mode == ANALOGWRITE)
+        return GPIOWrite(pin, mode, value);
+}
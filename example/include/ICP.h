@@ -0,0 +1,64 @@
+#ifndef ICP_h
+#define ICP_h
+
+#include "AVRLite.h"
+
+// Number of buffered captures (power of two)
+#ifndef ICP_BUFFER_SIZE
+#define ICP_BUFFER_SIZE 16
+#endif
+
+// Capture edges and options for ICP_begin
+#define ICP_RISING       0x1
+#define ICP_FALLING      0x2
+#define ICP_BOTH         0x3  // Alternate edges, needed for pulse widths
+#define ICP_NOISE_CANCEL 0x4  // Require 4 equal samples, adds a constant 4 cycle delay
+
+// Users of the Timer1 overflow count behind ICP_now
+#define ICP_TIMEBASE_CAPTURE    0x1  // ICP_begin
+#define ICP_TIMEBASE_COMPARATOR 0x2  // Comparator_begin without COMPARATOR_CAPTURE
+
+// Timer1 counts per microsecond, one count is 62.5 ns at 16 MHz
+#define ICP_TICKS_PER_US (F_CPU / 1000000UL)
+
+// A buffered capture: 32-bit timestamp in Timer1 counts and the edge that caused it
+typedef struct {
+    unsigned long timestamp;
+    uint8_t edge;  // ICP_RISING or ICP_FALLING
+} ICP_Capture;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Start capturing edges on ICP1 (D8)
+void ICP_begin(uint8_t mode);
+// Stop capturing
+void ICP_end();
+
+// Number of captures waiting in the buffer
+uint8_t ICP_available();
+// Take the oldest capture from the buffer, returns 0 if it is empty
+uint8_t ICP_read(ICP_Capture *capture);
+// Number of captures lost because the buffer was full
+unsigned int ICP_overruns();
+
+// Latest period between rising edges (falling edges for ICP_FALLING), in Timer1 counts
+unsigned long ICP_period();
+// Latest high time (ICP_BOTH only), in Timer1 counts
+unsigned long ICP_pulseWidth();
+// Frequency from the latest period in Hz, 0 before two edges were seen
+unsigned long ICP_frequency();
+// Timestamp of the latest edge that started a period, in Timer1 counts
+unsigned long ICP_lastEdge();
+
+// Current 32-bit Timer1 count, on the same time base as the capture timestamps
+unsigned long ICP_now();
+// Count Timer1 overflows for ICP_now for an ICP_TIMEBASE_ user, until the last user is released
+void __ICPTimebase__(uint8_t user);
+void __ICPTimebaseRelease__(uint8_t user);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,123 @@
+#include "Memory.h"
+
+#if AVRLITE_USE_MEMORY
+
+// Linker and avr-libc malloc symbols
+extern uint8_t __data_start;
+extern uint8_t __heap_start;
+extern uint8_t *__brkval;
+
+// avr-libc malloc free list (stdlib_private.h)
+struct __freelist {
+    size_t size;
+    struct __freelist *next;
+};
+extern struct __freelist *__flp;
+
+static uint16_t memory_guard = MEMORY_GUARD_BYTES;
+static void (*memory_handler)(uint16_t) = NULL;
+
+// Paint everything from the end of .bss up to RAMEND before the stack is used. Runs in .init1,
+// before the C runtime is set up, so it must not touch the stack or rely on r1 being zero.
+void __MemoryPaint__() __attribute__((naked, used, section(".init1")));
+void __MemoryPaint__() {
+    asm volatile(
+        "    ldi r30, lo8(__heap_start)\n"
+        "    ldi r31, hi8(__heap_start)\n"
+        "    ldi r24, %0\n"
+        "    ldi r25, hi8(%1)\n"
+        "1:  st Z+, r24\n"
+        "    cpi r30, lo8(%1)\n"
+        "    cpc r31, r25\n"
+        "    brlo 1b\n"
+        "    breq 1b\n"
+        :: "M" (MEMORY_SENTINEL), "i" (RAMEND));
+}
+
+// End of the heap, or its start while nothing was allocated
+static uint8_t *__heapEnd__() {
+    return __brkval ? __brkval : &__heap_start;
+}
+
+// First byte of the untouched gap: past the heap end and past what freed blocks left above it
+static uint8_t *__gapStart__() {
+    uint8_t *p = __heapEnd__();
+    uint8_t run = 0;
+    while ((uintptr_t)p <= SP && run < MEMORY_SENTINEL_RUN) {
+        run = (*p == MEMORY_SENTINEL) ? run + 1 : 0;
+        p++;
+    }
+    return p - run;
+}
+
+// Lowest address the stack has reached: first byte above the gap that lost the sentinel
+static uint8_t *__stackLow__(uint8_t *gap) {
+    uint8_t *p = gap;
+    while ((uintptr_t)p <= SP && *p == MEMORY_SENTINEL)
+        p++;
+    return p;
+}
+
+// Fill `stats` with the current RAM usage
+void Memory_stats(MemoryStats *stats) {
+    uint8_t *heapEnd = __heapEnd__();
+    uint8_t *gap = __gapStart__();
+    uint8_t *stackLow = __stackLow__(gap);
+    uint16_t sp = SP;
+
+    stats->staticSize = &__heap_start - &__data_start;
+    stats->heapSize = heapEnd - &__heap_start;
+
+    uint16_t free = 0, largest = 0;
+    uint8_t oldSREG = SREG;
+    cli();  // malloc may run in an ISR
+    for (struct __freelist *block = __flp; block; block = block->next) {
+        // Each free block also gives back its size header
+        uint16_t size = block->size + sizeof(size_t);
+        free += size;
+        if (size > largest)
+            largest = size;
+    }
+    SREG = oldSREG;
+    stats->heapFree = free;
+    stats->heapLargest = largest;
+    stats->fragmentation = free ? 100 - (uint8_t)((uint32_t)largest * 100 / free) : 0;
+
+    stats->stackSize = RAMEND - sp;
+    stats->stackMax = RAMEND + 1 - (uintptr_t)stackLow;
+    stats->freeNow = sp + 1 - (uintptr_t)heapEnd;
+    stats->freeMin = stackLow - gap;
+}
+
+// Print the RAM usage as one line over Serial
+void Memory_report() {
+    MemoryStats stats;
+    Memory_stats(&stats);
+    Serial_printf_P(PSTR("ram static=%u heap=%u free_list=%u frag=%u%% stack=%u stack_max=%u free=%u free_min=%u\n"),
+                    stats.staticSize, stats.heapSize, stats.heapFree, stats.fragmentation,
+                    stats.stackSize, stats.stackMax, stats.freeNow, stats.freeMin);
+}
+
+// Call `handler` from Memory_check when less than `bytes` stay untouched between heap and stack
+void Memory_setGuard(uint16_t bytes, void (*handler)(uint16_t freeMin)) {
+    memory_guard = bytes;
+    memory_handler = handler;
+}
+
+// Check the guard band, returns 1 (and calls the handler) if it was breached
+uint8_t Memory_check() {
+    uint8_t *gap = __gapStart__();
+
+    // Past the heap only the guard band is scanned, so this is cheap enough for every loop iteration
+    uint16_t untouched = 0;
+    while (untouched < memory_guard && (uintptr_t)(gap + untouched) <= SP && gap[untouched] == MEMORY_SENTINEL)
+        untouched++;
+    if (untouched >= memory_guard)
+        return 0;
+
+    if (memory_handler)
+        memory_handler(untouched);
+    return 1;
+}
+
+#endif
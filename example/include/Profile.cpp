@@ -0,0 +1,89 @@
+#include "Profile.h"
+
+#ifdef AVRLITE_PROFILE
+
+Profile_Probe profile_probes[PROFILE_PROBES];
+uint16_t profile_latency_min = 0xFFFF, profile_latency_max;
+
+static PGM_P profile_names[PROFILE_PROBES];
+static const char profile_timer0_name[] PROGMEM = "TIMER0_OVF_vect";
+static const char profile_timer1_name[] PROGMEM = "TIMER1_COMPA_vect";
+static const char profile_timer2_name[] PROGMEM = "TIMER2_COMPA_vect";
+
+// Cycles a probe adds to its own measurement (the two counter reads)
+static uint16_t __profileOverhead__() {
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t start = __profileCounter__();
+    uint16_t end = __profileCounter__();
+    SREG = oldSREG;
+    return end - start;
+}
+
+// Name a probe for Profile_dump (string in flash)
+void Profile_name(uint8_t id, PGM_P name) {
+    // Probes read the free-running Timer1
+    __TimeBegin__();
+    if (id < PROFILE_PROBES)
+        profile_names[id] = name;
+}
+
+// Copy the statistics of a probe, with the probe overhead already subtracted
+void Profile_read(uint8_t id, Profile_Probe *probe) {
+    uint8_t oldSREG = SREG;
+    cli();
+    *probe = profile_probes[id];
+    SREG = oldSREG;
+
+    uint16_t overhead = __profileOverhead__();
+    probe->min = probe->min > overhead ? probe->min - overhead : 0;
+    probe->max = probe->max > overhead ? probe->max - overhead : 0;
+    unsigned long totalOverhead = probe->count * overhead;
+    probe->total = probe->total > totalOverhead ? probe->total - totalOverhead : 0;
+}
+
+// Print all probes that have samples and the interrupt latency as a table over Serial
+void Profile_dump() {
+    Serial_println_P(PSTR("probe                     count      min      avg      max  (cycles)"));
+    for (uint8_t id = 0; id < PROFILE_PROBES; id++) {
+        Profile_Probe probe;
+        Profile_read(id, &probe);
+        if (probe.count == 0)
+            continue;
+
+        PGM_P name = profile_names[id];
+        if (!name)
+            name = id == PROFILE_TIMER0 ? profile_timer0_name : id == PROFILE_TIMER1 ? profile_timer1_name :
+                   id == PROFILE_TIMER2 ? profile_timer2_name : NULL;
+        if (name)
+            Serial_printf_P(PSTR("%-20S"), name);
+        else
+            Serial_printf_P(PSTR("#%-19u"), id);
+        Serial_printf_P(PSTR("%10lu %8u %8lu %8u\n"), probe.count, probe.min, probe.total / probe.count, probe.max);
+    }
+
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t latencyMin = profile_latency_min, latencyMax = profile_latency_max;
+    SREG = oldSREG;
+    if (latencyMax)
+        Serial_printf_P(PSTR("interrupt latency: %u..%u cycles\n"), latencyMin, latencyMax);
+}
+
+// Clear all statistics
+void Profile_reset() {
+    __TimeBegin__();
+    uint8_t oldSREG = SREG;
+    cli();
+    for (uint8_t id = 0; id < PROFILE_PROBES; id++) {
+        profile_probes[id].count = 0;
+        profile_probes[id].total = 0;
+        profile_probes[id].min = 0;
+        profile_probes[id].max = 0;
+    }
+    profile_latency_min = 0xFFFF;
+    profile_latency_max = 0;
+    SREG = oldSREG;
+}
+
+#endif
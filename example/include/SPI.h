@@ -0,0 +1,77 @@
+#ifndef SPI_h
+#define SPI_h
+
+#include "AVRLite.h"
+
+// SPI modes (clock polarity and phase)
+#define SPI_MODE0 0x0
+#define SPI_MODE1 0x1
+#define SPI_MODE2 0x2
+#define SPI_MODE3 0x3
+
+// Bit order
+#define SPI_MSBFIRST 0x0
+#define SPI_LSBFIRST 0x1
+
+// Fastest SPI clock, F_CPU / 2
+#define SPI_MAX_CLOCK (F_CPU / 2)
+
+// Job status for asynchronous transfers
+#define SPI_IDLE    0x0
+#define SPI_PENDING 0x1
+#define SPI_BUSY    0x2
+#define SPI_DONE    0x3
+
+// Per-device settings, filled in by SPI_device
+typedef struct {
+    uint8_t csPin;  // Chip select, active low
+    uint8_t spcr;
+    uint8_t spsr;
+} SPI_Device;
+
+struct SPI_Job;
+// Completion callback, runs inside the SPI interrupt so keep it short
+typedef void (*SPI_Callback)(struct SPI_Job *job);
+
+// A queued asynchronous transfer, tx or rx may be NULL
+typedef struct SPI_Job {
+    const SPI_Device *device;
+    const uint8_t *tx;
+    uint8_t *rx;
+    uint16_t length;
+    SPI_Callback callback;      // Optional, may be NULL
+    volatile uint8_t status;
+    struct SPI_Job *next;
+} SPI_Job;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Initialize the SPI master pins: SCK (D13), MOSI (D11), MISO (D12) and SS (D10)
+void SPI_begin();
+
+// Describe a device: chip select pin, mode, highest clock it accepts and bit order
+void SPI_device(SPI_Device *device, uint8_t csPin, uint8_t mode, unsigned long clock, uint8_t bitOrder = SPI_MSBFIRST);
+
+// Apply the device settings and pull its chip select low
+void SPI_select(const SPI_Device *device);
+// Release the chip select
+void SPI_deselect(const SPI_Device *device);
+
+// Exchange a single byte
+uint8_t SPI_transfer(uint8_t data);
+// Polled burst transfers, the next byte is loaded while the current one is on the wire
+void SPI_write(const uint8_t *data, uint16_t length);
+void SPI_read(uint8_t *data, uint16_t length, uint8_t fill = 0xFF);
+void SPI_transferBuffer(const uint8_t *tx, uint8_t *rx, uint16_t length);
+
+// Queue an interrupt-driven transfer (selects and deselects the device), returns 0 if already queued
+int SPI_submit(SPI_Job *job);
+// Return 1 while asynchronous jobs are queued or running
+uint8_t SPI_busy();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
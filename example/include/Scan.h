@@ -0,0 +1,71 @@
+#ifndef Scan_h
+#define Scan_h
+
+#include "AVRLite.h"
+
+// Most rows (digits) and columns (keypad inputs)
+#ifndef SCAN_MAX_ROWS
+#define SCAN_MAX_ROWS 8
+#endif
+
+// Frames a key matrix has to read the same before key events are sent
+#ifndef SCAN_DEBOUNCE
+#define SCAN_DEBOUNCE 2
+#endif
+
+// Key event queue (power of two, at most 128)
+#ifndef SCAN_EVENT_BUFFER_SIZE
+#define SCAN_EVENT_BUFFER_SIZE 8
+#endif
+
+// Scan_begin flags
+#define SCAN_ROW_ACTIVE_LOW  0x1  // A row is selected by driving it LOW (e.g. common cathode digits)
+#define SCAN_DATA_ACTIVE_LOW 0x2  // A segment is lit by driving its pin LOW (e.g. common anode digits)
+
+// Key events: row * columns + column, with SCAN_KEY_RELEASED set on release
+#define SCAN_KEY_RELEASED 0x80
+
+// 7-segment pattern bits (bit 0 = segment a ... bit 6 = segment g, bit 7 = decimal point)
+#define SCAN_SEGMENT_DP 0x80
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Start scanning on Timer2 (CTC), one row per tick at frameRate * rows ticks per second. The data pins
+// (bit 0 of a pattern first) must share one port. Returns 0 for a bad pin set or an unreachable rate.
+uint8_t Scan_begin(const uint8_t *rowPins, uint8_t rows, const uint8_t *dataPins, uint8_t dataCount,
+                   uint8_t flags, uint16_t frameRate);
+
+// Read a key matrix on the same rows: column inputs (one port, pull-ups on) are sampled before each
+// row is released. Rows must be active low for the pull-ups, returns 0 if the pins are not on one port.
+uint8_t Scan_keypad(const uint8_t *columnPins, uint8_t columns);
+
+// Stop the timer and release all rows
+void Scan_end();
+
+// Set a row of the back buffer, bit n of the pattern drives data pin n
+void Scan_write(uint8_t row, uint8_t pattern);
+
+// Fill the back buffer with text for 7-segment digits ('.' lights the previous decimal point)
+void Scan_print(const char *text);
+
+// 7-segment pattern of a character (0-9, A-Z approximations, '-', '_', ' ')
+uint8_t Scan_segments(char c);
+
+// Show the back buffer from the start of the next frame
+void Scan_swap();
+
+// 1 once the last Scan_swap has taken effect, draw the next frame only then
+uint8_t Scan_ready();
+
+// Take the next key event, returns 0 if there is none
+uint8_t Scan_readKey(uint8_t *event);
+
+// Frames whose key readings were rejected because of ghosting (3 keys on the corners of a rectangle)
+unsigned long Scan_ghosts();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
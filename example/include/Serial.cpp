@@ -0,0 +1,227 @@
+#include "AVRLite.h"
+#include "RingBuffer.h"
+#include "Power.h"
+
+// Baud rate error of the last Serial_begin, in hundredths of a percent
+static int16_t serial_baud_error;
+
+// Program the USART with a baud setting (U2X flag + UBRR) and its error
+int __SerialApplyBaud__(uint16_t setting, int16_t error) {
+    uint16_t ubrr = setting & ~SERIAL_U2X_FLAG;
+    serial_baud_error = error;
+    Power_enable(POWER_USART0);
+    // Double-speed mode divides the clock by 8 instead of 16
+    UCSR0A = (setting & SERIAL_U2X_FLAG) ? (1 << U2X0) : 0;
+    // Set baud rate
+    UBRR0H = (unsigned char)(ubrr >> 8);
+    UBRR0L = (unsigned char)ubrr;
+    // Enable receiver and transmitter
+    UCSR0B = (1 << RXEN0) | (1 << TXEN0);
+    // Set frame format: 8 data bits, 1 stop bit
+    UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
+    // Transmit (and Command's receive) are interrupt-driven
+    sei();
+
+    return 1;
+}
+
+// Initialize Serial communication, returns 0 if the baud rate is out of tolerance
+int Serial_begin(unsigned long baud) {
+    if (baud < 100) return 0;
+
+    uint16_t setting = __SerialBaudSetting__(baud);
+    int16_t error = __SerialSettingError__(baud, setting);
+    if (__SerialAbs__(error) > SERIAL_BAUD_TOLERANCE) {
+        // Leave the USART untouched, but report why
+        serial_baud_error = error;
+        return 0;
+    }
+
+    return __SerialApplyBaud__(setting, error);
+}
+
+// Baud rate error of the last Serial_begin, in hundredths of a percent
+int16_t Serial_baudError() {
+    return serial_baud_error;
+}
+
+// Interrupt-driven transmit buffer, filled by Serial_queue and drained by USART_UDRE_vect
+static RingBuffer<uint8_t, SERIAL_TX_BUFFER_SIZE> serial_tx;
+
+// Interrupt Service Routine (ISR) for USART data register empty
+ISR(USART_UDRE_vect) {
+    uint8_t c;
+    if (serial_tx.pop(c))
+        UDR0 = c;
+    if (serial_tx.empty())
+        UCSR0B &= ~(1 << UDRIE0);  // Nothing left to send
+}
+
+// Conditions for __SerialWait__, evaluated with interrupts off
+static uint8_t __SerialFull__() {
+    return serial_tx.full();
+}
+
+static uint8_t __SerialBusy__() {
+    return !serial_tx.empty();
+}
+
+// Idle until the transmit ISR has sent a byte, unless `busy` stopped holding meanwhile. With
+// interrupts off (in an ISR or a critical section) the ISR cannot run, so the oldest byte is
+// sent here by polling UDRE0, which keeps the byte order.
+static void __SerialWait__(uint8_t (*busy)()) {
+    if (SREG & (1 << SREG_I)) {
+        Power_idleIf(busy);
+        return;
+    }
+    uint8_t c;
+    if (serial_tx.pop(c)) {
+        while (!(UCSR0A & (1 << UDRE0)));
+        UDR0 = c;
+    }
+}
+
+// Queue a byte for interrupt-driven transmit, waits while the buffer is full
+void Serial_queue(uint8_t c) {
+    // Wait for the ISR to make room, or make it by polling with interrupts off
+    while (!serial_tx.push(c))
+        __SerialWait__(__SerialFull__);
+
+    uint8_t oldSREG = SREG;
+    cli();
+    UCSR0B |= (1 << UDRIE0);
+    SREG = oldSREG;
+}
+
+// Number of free bytes in the Serial transmit buffer
+uint8_t Serial_txFree() {
+    return serial_tx.space();
+}
+
+// Wait until all queued bytes have been sent
+void Serial_flush() {
+    while (!serial_tx.empty())
+        __SerialWait__(__SerialBusy__);
+}
+
+// Write a single character to Serial
+void __SerialWriteChar__(char c) {
+    // Keep byte order when the transmit buffer is in use
+    Serial_flush();
+    while (!(UCSR0A & (1 << UDRE0)));
+    UDR0 = c;
+}
+
+// Write data to Serial
+void Serial_write(const char* str) {
+    __SerialWriteChar__(*str);
+}
+
+// Write data to Serial with newline conversion
+void Serial_print(const char* str) {
+    while (*str) {
+        if (*str == '\n') {
+            // Send '\r' first for newline compatibility
+            __SerialWriteChar__('\r');
+        }
+        __SerialWriteChar__(*str);
+        str++;
+    }
+}
+
+// Write data to Serial with newline
+void Serial_println(const char* str) {
+    Serial_print(str);
+    Serial_print_P(PSTR("\n"));
+}
+
+// Formatted print of a flash-resident format string with dynamic buffer
+void __SerialVPrintf_P__(PGM_P format, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+
+    // Calculate the size needed
+    int size = vsnprintf_P(NULL, 0, format, copy) + 1; // +1 for null terminator
+    va_end(copy);
+
+    // Allocate buffer dynamically
+    char *buffer = (char *)malloc(size);
+    if (buffer == NULL) {
+        // Handle memory alloaction failure
+        Serial_println_P(PSTR("Error: Memory allocation failed"));
+        return;
+    }
+
+    vsnprintf_P(buffer, size, format, args);
+
+    Serial_print(buffer);
+    free(buffer); // Free the allocated memory
+}
+
+// Formatted print to Serial with dynamic buffer
+void Serial_printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+
+    // Calculate the size needed
+    int size = vsnprintf(NULL, 0, format, args) + 1; // +1 for null terminator
+    va_end(args);
+
+    // Allocate buffer dynamically
+    char *buffer = (char *)malloc(size);
+    if (buffer == NULL) {
+        // Handle memory alloaction failure
+        Serial_println_P(PSTR("Error: Memory allocation failed"));
+        return;
+    }
+
+    va_start(args, format);
+    vsnprintf(buffer, size, format, args);
+    va_end(args);
+
+    Serial_print(buffer);
+    free(buffer); // Free the allocated memory
+}
+
+// Write a flash-resident (PROGMEM) string to Serial with newline conversion
+void Serial_print_P(PGM_P str) {
+    char c;
+    // Stream bytes straight from flash, no SRAM copy
+    while ((c = pgm_read_byte(str++))) {
+        if (c == '\n') {
+            // Send '\r' first for newline compatibility
+            __SerialWriteChar__('\r');
+        }
+        __SerialWriteChar__(c);
+    }
+}
+
+// Write a flash-resident string to Serial with newline
+void Serial_println_P(PGM_P str) {
+    Serial_print_P(str);
+    Serial_print_P(PSTR("\n"));
+}
+
+// Formatted print to Serial with a flash-resident format string
+void Serial_printf_P(PGM_P format, ...) {
+    va_list args;
+    va_start(args, format);
+    __SerialVPrintf_P__(format, args);
+    va_end(args);
+}
+
+// Overloads for F("...") strings
+void Serial_print(const __FlashStringHelper *str) {
+    Serial_print_P(reinterpret_cast<PGM_P>(str));
+}
+
+void Serial_println(const __FlashStringHelper *str) {
+    Serial_println_P(reinterpret_cast<PGM_P>(str));
+}
+
+void Serial_printf(const __FlashStringHelper *format, ...) {
+    va_list args;
+    va_start(args, format);
+    __SerialVPrintf_P__(reinterpret_cast<PGM_P>(format), args);
+    va_end(args);
+}
@@ -0,0 +1,118 @@
+#include "Telemetry.h"
+#include <string.h>
+#include <util/crc16.h>
+
+#if AVRLITE_USE_TELEMETRY
+
+#if TELEMETRY_MAX_FRAME > 252
+#error "TELEMETRY_MAX_FRAME must be at most 252 so a frame fits one COBS block"
+#endif
+
+// Frame header: sequence number (1 byte) + uptimeUs() timestamp (4 bytes)
+#define TELEMETRY_HEADER_SIZE 5
+
+// Raw frame being built, with room for the CRC
+static uint8_t telemetry_frame[TELEMETRY_MAX_FRAME + 2];
+static uint8_t telemetry_length;
+static uint8_t telemetry_sequence;
+static uint8_t telemetry_mode;
+static unsigned long telemetry_dropped;
+
+// Select the backpressure behaviour (TELEMETRY_BLOCK or TELEMETRY_DROP)
+void Telemetry_begin(uint8_t mode) {
+    telemetry_mode = mode;
+    telemetry_sequence = 0;
+    telemetry_dropped = 0;
+    telemetry_length = 0;
+}
+
+// Start a new frame stamped with uptimeUs() and the next sequence number
+void Telemetry_startFrame() {
+    unsigned long now = uptimeUs();
+
+    telemetry_frame[0] = telemetry_sequence++;
+    memcpy(&telemetry_frame[1], &now, sizeof(now)); // Little endian, like the host
+    telemetry_length = TELEMETRY_HEADER_SIZE;
+}
+
+// Append a record tag and its value to the current frame
+uint8_t __TelemetryAdd__(uint8_t id, uint8_t type, const void *value, uint8_t size) {
+    if (telemetry_length == 0 || telemetry_length + 1 + size > TELEMETRY_MAX_FRAME)
+        return 0;
+
+    telemetry_frame[telemetry_length++] = (type << 5) | (id & 0x1F);
+    memcpy(&telemetry_frame[telemetry_length], value, size);
+    telemetry_length += size;
+    return 1;
+}
+
+uint8_t Telemetry_addU8(uint8_t id, uint8_t value) {
+    return __TelemetryAdd__(id, TELEMETRY_U8, &value, sizeof(value));
+}
+
+uint8_t Telemetry_addI8(uint8_t id, int8_t value) {
+    return __TelemetryAdd__(id, TELEMETRY_I8, &value, sizeof(value));
+}
+
+uint8_t Telemetry_addU16(uint8_t id, uint16_t value) {
+    return __TelemetryAdd__(id, TELEMETRY_U16, &value, sizeof(value));
+}
+
+uint8_t Telemetry_addI16(uint8_t id, int16_t value) {
+    return __TelemetryAdd__(id, TELEMETRY_I16, &value, sizeof(value));
+}
+
+uint8_t Telemetry_addU32(uint8_t id, uint32_t value) {
+    return __TelemetryAdd__(id, TELEMETRY_U32, &value, sizeof(value));
+}
+
+uint8_t Telemetry_addI32(uint8_t id, int32_t value) {
+    return __TelemetryAdd__(id, TELEMETRY_I32, &value, sizeof(value));
+}
+
+uint8_t Telemetry_addFloat(uint8_t id, float value) {
+    return __TelemetryAdd__(id, TELEMETRY_FLOAT, &value, sizeof(value));
+}
+
+// COBS-encode the frame with its CRC-16 and queue it for transmit, returns 0 if dropped
+uint8_t Telemetry_send() {
+    uint8_t length = telemetry_length;
+    uint16_t crc = 0xFFFF;
+
+    if (length == 0)
+        return 0;
+    telemetry_length = 0;
+
+    // CRC-16/CCITT over header and records, appended little endian
+    for (uint8_t i = 0; i < length; i++)
+        crc = _crc_ccitt_update(crc, telemetry_frame[i]);
+    telemetry_frame[length++] = crc & 0xFF;
+    telemetry_frame[length++] = crc >> 8;
+
+    // One COBS overhead byte plus the 0x00 delimiter
+    if (telemetry_mode == TELEMETRY_DROP && Serial_txFree() < length + 2) {
+        telemetry_dropped++;
+        return 0;
+    }
+
+    // COBS: every zero is replaced by the distance to the next zero
+    uint8_t start = 0;
+    for (uint8_t i = 0; i <= length; i++) {
+        if (i == length || telemetry_frame[i] == 0) {
+            Serial_queue(i - start + 1);
+            while (start < i)
+                Serial_queue(telemetry_frame[start++]);
+            start = i + 1;
+        }
+    }
+    Serial_queue(0x00); // Frame delimiter
+
+    return 1;
+}
+
+// Number of frames dropped because of backpressure
+unsigned long Telemetry_dropped() {
+    return telemetry_dropped;
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef Telemetry_h
+#define Telemetry_h
+
+#include "AVRLite.h"
+
+// Largest raw frame (header + records, without CRC) in bytes, at most 252
+#ifndef TELEMETRY_MAX_FRAME
+#define TELEMETRY_MAX_FRAME 48
+#endif
+
+// Behaviour when the Serial transmit buffer has no room for a frame
+#define TELEMETRY_BLOCK 0x0  // Wait for the buffer to drain
+#define TELEMETRY_DROP  0x1  // Drop the frame and count it
+
+// Record types, stored in the upper 3 bits of a record tag
+#define TELEMETRY_U8    0x0
+#define TELEMETRY_I8    0x1
+#define TELEMETRY_U16   0x2
+#define TELEMETRY_I16   0x3
+#define TELEMETRY_U32   0x4
+#define TELEMETRY_I32   0x5
+#define TELEMETRY_FLOAT 0x6
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Select the backpressure behaviour (TELEMETRY_BLOCK or TELEMETRY_DROP)
+void Telemetry_begin(uint8_t mode);
+
+// Start a new frame stamped with uptimeUs() and the next sequence number
+void Telemetry_startFrame();
+
+// Append a typed record (id 0-31) to the current frame, returns 0 if the frame is full
+uint8_t Telemetry_addU8(uint8_t id, uint8_t value);
+uint8_t Telemetry_addI8(uint8_t id, int8_t value);
+uint8_t Telemetry_addU16(uint8_t id, uint16_t value);
+uint8_t Telemetry_addI16(uint8_t id, int16_t value);
+uint8_t Telemetry_addU32(uint8_t id, uint32_t value);
+uint8_t Telemetry_addI32(uint8_t id, int32_t value);
+uint8_t Telemetry_addFloat(uint8_t id, float value);
+
+// COBS-encode the frame with its CRC-16 and queue it for transmit, returns 0 if dropped
+uint8_t Telemetry_send();
+
+// Number of frames dropped because of backpressure
+unsigned long Telemetry_dropped();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,123 @@
+#include "AVRLite.h"
+#include "Profile.h"
+#include "Power.h"
+#include "Work.h"
+
+#if AVRLITE_USE_WORK
+// Weak, so sleep() does not pull Work.o (and its queues) into firmware that never calls Work_post
+extern "C" uint8_t Work_run(uint8_t budget) __attribute__((weak));
+#endif
+
+// Interrupt Service Routine (ISR) for Timer0 overflow
+volatile unsigned long timer0_overflow_count;
+ISR(TIMER0_OVF_vect) {
+    PROFILE_SCOPE(PROFILE_TIMER0);
+    timer0_overflow_count++;
+}
+
+// Interrupt Service Routine (ISR) for Timer1 compare match, once per millisecond
+volatile unsigned long timer1_overflow_count;
+ISR(TIMER1_COMPA_vect) {
+    // Cycles since the compare match, includes any time interrupts were blocked
+    PROFILE_LATENCY(TCNT1 - OCR1A);
+    PROFILE_SCOPE(PROFILE_TIMER1);
+    // Move the compare point one millisecond ahead, Timer1 itself keeps running
+    OCR1A += TIMER1_TICKS_PER_MS;
+    timer1_overflow_count++;
+}
+
+static volatile uint8_t time_started;
+
+// Start Timer0 and Timer1 on the first time query, firmware that never asks costs nothing
+void __TimeBegin__() {
+    if (time_started)
+        return;
+
+    uint8_t oldSREG = SREG;
+    cli();
+    time_started = 1;
+    Power_enable(POWER_TIMER0 | POWER_TIMER1);
+
+    // Initialize Timer0 for uptimeUs
+    TCNT0 = 0;  // Initialize counter value to 0
+    // Set Timer0 prescaler to 64, TCCR0A is kept: PWM on D5/D6 also overflows at 0xFF
+    TCCR0B = (TCCR0B & ~((1 << CS02) | (1 << CS01) | (1 << CS00))) | (1 << CS01) | (1 << CS00);
+    // Enable Timer0 overflow interrupt
+    TIMSK0 |= (1 << TOIE0);
+
+    // Initialize Timer1 for uptimeMs
+    TCCR1A = 0;  // Set entire TCCR1A register to 0
+    TCCR1B = 0;  // Same for TCCR1B (normal mode, counts 0 to 0xFFFF)
+    TCNT1 = 0;   // Initialize counter value to 0
+    // First compare match after 1 ms, the ISR moves it ahead from there
+    OCR1A = TIMER1_TICKS_PER_MS;  // = 16MHz / 1000 (must be <65536)
+    // Set CS10 bit for no prescaler, TCNT1 counts CPU cycles (input capture, profiling)
+    TCCR1B |= (1 << CS10);
+    // Enable timer compare interrupt
+    TIMSK1 |= (1 << OCIE1A);
+
+    // The caller may be an ISR or a critical section (Trace_record), so interrupts are left as they
+    // were: the begin functions and sleep() turn them on
+    SREG = oldSREG;
+}
+
+// Return the number of milliseconds since timekeeping started (the first time query)
+unsigned long uptimeMs() {
+    unsigned long m;
+    __TimeBegin__();
+    // Enter critical section
+    uint8_t oldSREG = SREG;
+    cli();
+    m = timer1_overflow_count;
+    SREG = oldSREG;
+    return m;
+}
+
+// Return the number of microseconds since timekeeping started (the first time query)
+unsigned long uptimeUs() {
+    unsigned long m;
+    __TimeBegin__();
+    uint8_t oldSREG = SREG, t;
+
+    cli();
+    m = timer0_overflow_count;
+    t = TCNT0;
+    if ((TIFR0 & (1 << TOV0) && (t < 255)))
+        m++;
+    
+    SREG = oldSREG;
+
+    // Timer0 ticks every 64 cycles, 256 ticks per overflow
+    return ((m << 8) + t) * (64 / (F_CPU / 1000000L));
+}
+
+// Sleep for a specified number of milliseconds
+void sleep(unsigned long ms) {
+    unsigned long start = uptimeUs();
+    // Called from the main loop only, and it waits for the timer interrupts
+    sei();
+
+    while (ms > 0) {
+        // Idle between timer interrupts instead of spinning, unless interrupts are off
+        while ((uptimeUs() - start) < 1000) {
+            if (SREG & (1 << SREG_I)) {
+#if AVRLITE_USE_WORK
+                // Deferred work first, idle once there is none. Handlers can make sleep() overrun.
+                if (Work_run && Work_run(WORK_BATCH))
+                    continue;
+#endif
+                Power_idle();
+            }
+        }
+        ms--;
+        start += 1000;
+    }
+}
+
+// Sleep for a specified number of microseconds
+void sleepMicroseconds(unsigned int us) {
+    while(us > 0) {
+        _delay_us(1);
+        us--;
+    }
+}
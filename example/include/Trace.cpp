@@ -0,0 +1,147 @@
+#include "Trace.h"
+
+#ifdef AVRLITE_TRACE
+
+static Trace_Record trace_buffer[TRACE_BUFFER_SIZE];
+static uint8_t trace_first, trace_count;
+
+// Time the oldest record's delta counts from, and the time of the newest record
+static unsigned long trace_base_time, trace_last_time;
+
+static volatile uint8_t trace_frozen;
+static uint8_t trace_trigger_tag = 0xFF;  // 0xFF: no trigger armed
+static uint16_t trace_trigger_value;
+static uint8_t trace_trigger_after;
+static uint8_t trace_countdown;           // Records left until freezing, +1 (0: not counting)
+
+// Microseconds between a record and the one before it
+static unsigned long __traceDelta__(const Trace_Record *record) {
+    if ((record->tag >> 5) == TRACE_TIME)
+        return ((unsigned long)record->value << 16) | record->delta;
+    return record->delta;
+}
+
+// Store a record, overwriting the oldest one when the buffer is full
+static void __tracePush__(uint8_t tag, uint16_t value, uint16_t delta) {
+    uint8_t index = (trace_first + trace_count) & (TRACE_BUFFER_SIZE - 1);
+    if (trace_count == TRACE_BUFFER_SIZE) {
+        trace_base_time += __traceDelta__(&trace_buffer[trace_first]);
+        trace_first = (trace_first + 1) & (TRACE_BUFFER_SIZE - 1);
+    } else {
+        trace_count++;
+    }
+
+    Trace_Record *record = &trace_buffer[index];
+    record->tag = tag;
+    record->value = value;
+    record->delta = delta;
+}
+
+// Append a record (used by the GPIO functions and TRACE_MARK)
+void Trace_record(uint8_t kind, uint8_t pin, uint16_t value) {
+    if (trace_frozen)
+        return;
+
+    uint8_t oldSREG = SREG;
+    cli();  // Records also come from ISRs
+    unsigned long now = uptimeUs();
+    unsigned long delta = now - trace_last_time;
+    trace_last_time = now;
+
+    if (delta > 0xFFFF) {
+        __tracePush__(TRACE_TIME << 5, delta >> 16, delta);
+        delta = 0;
+    }
+    uint8_t tag = (kind << 5) | (pin & 0x1F);
+    __tracePush__(tag, value, delta);
+
+    if (trace_countdown) {
+        if (--trace_countdown == 0)
+            trace_frozen = 1;
+    } else if (tag == trace_trigger_tag && value == trace_trigger_value) {
+        trace_trigger_tag = 0xFF;
+        trace_countdown = trace_trigger_after;
+        if (trace_countdown == 0)
+            trace_frozen = 1;
+    }
+    SREG = oldSREG;
+}
+
+// Freeze `after` records after one matching kind, pin and value, like a logic analyzer trigger
+void Trace_trigger(uint8_t kind, uint8_t pin, uint16_t value, uint8_t after) {
+    uint8_t oldSREG = SREG;
+    cli();
+    trace_trigger_tag = (kind << 5) | (pin & 0x1F);
+    trace_trigger_value = value;
+    trace_trigger_after = after;
+    trace_countdown = 0;
+    SREG = oldSREG;
+}
+
+// Stop capturing now
+void Trace_freeze() {
+    trace_frozen = 1;
+}
+
+// Capture again, disarms the trigger
+void Trace_resume() {
+    uint8_t oldSREG = SREG;
+    cli();
+    trace_trigger_tag = 0xFF;
+    trace_countdown = 0;
+    trace_frozen = 0;
+    SREG = oldSREG;
+}
+
+// 1 once the trace is frozen
+uint8_t Trace_frozen() {
+    return trace_frozen;
+}
+
+// Number of records in the buffer
+uint8_t Trace_count() {
+    return trace_count;
+}
+
+// Drop all records
+void Trace_clear() {
+    uint8_t oldSREG = SREG;
+    cli();
+    trace_first = 0;
+    trace_count = 0;
+    trace_base_time = trace_last_time;
+    SREG = oldSREG;
+}
+
+static void __traceQueueWord__(uint16_t value) {
+    Serial_queue(value);
+    Serial_queue(value >> 8);
+}
+
+// Send the buffer over Serial in binary, oldest record first
+void Trace_dump() {
+    // Hold the capture while sending, Serial writes must not end up in the dump
+    uint8_t wasFrozen = trace_frozen;
+    trace_frozen = 1;
+
+    Serial_queue('A');
+    Serial_queue('V');
+    Serial_queue('T');
+    Serial_queue('R');
+    Serial_queue(TRACE_DUMP_VERSION);
+    Serial_queue(trace_count);
+    __traceQueueWord__(trace_base_time);
+    __traceQueueWord__(trace_base_time >> 16);
+
+    for (uint8_t i = 0; i < trace_count; i++) {
+        const Trace_Record *record = &trace_buffer[(trace_first + i) & (TRACE_BUFFER_SIZE - 1)];
+        Serial_queue(record->tag);
+        __traceQueueWord__(record->value);
+        __traceQueueWord__(record->delta);
+    }
+    Serial_flush();
+
+    trace_frozen = wasFrozen;
+}
+
+#endif
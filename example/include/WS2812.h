@@ -0,0 +1,34 @@
+#ifndef WS2812_h
+#define WS2812_h
+
+#include "AVRLite.h"
+
+// Byte order of the pixel buffer
+#define WS2812_GRB 0x0  // Native strip order, 3 bytes per pixel: green, red, blue
+#define WS2812_RGB 0x1  // Reordered on the fly while sending
+
+// Low time that latches a frame, in microseconds (use 300 for WS2812B-V5 / newer parts)
+#ifndef WS2812_RESET_US
+#define WS2812_RESET_US 80
+#endif
+
+// Set to 1 to allow interrupts between pixels instead of disabling them for the whole frame.
+// Every ISR must then finish well within WS2812_RESET_US or the strip latches early.
+#ifndef WS2812_PIXEL_CRITICAL
+#define WS2812_PIXEL_CRITICAL 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Configure the data pin as a LOW output
+void WS2812_begin(uint8_t pin);
+
+// Send `count` pixels and scale every byte by brightness (255 = unchanged) in the same pass
+void WS2812_show(uint8_t pin, const uint8_t *pixels, uint16_t count, uint8_t order = WS2812_GRB, uint8_t brightness = 255);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
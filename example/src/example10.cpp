@@ -0,0 +1,53 @@
+/**
+ *  @file example10.cpp
+ *  @brief Mains zero-cross detector with the analog comparator
+ *
+ *  This program compares a scaled-down AC signal against its bias voltage, so the comparator output
+ *  flips at every zero crossing. Each accepted crossing is timestamped on Timer1 and mirrored on the
+ *  LED; once a second the line frequency and the phase of the current moment are printed.
+ *
+ *  @details
+ *  - AC signal (divided to a few volts peak-to-peak around 2.5 V) on AIN0 (D6), 2.5 V bias on AIN1 (D7).
+ *  - 2 ms holdoff against chatter near the crossing, far below a 10 ms half cycle.
+ *  - LED on D13 follows the comparator output.
+ *  - Output at 115200 baud, e.g. "50.02 Hz, 100 crossings, phase 187 deg".
+ */
+
+#include "AVRLite.h"
+#include "Comparator.h"
+
+static void crossing(uint8_t level) {
+    GPIOWrite(D13, level ? HIGH : LOW);
+}
+
+int main() {
+    Serial_begin<115200>();
+    GPIOInit(D13, OUTPUT);
+
+    Comparator_begin(D6, D7, COMPARATOR_TOGGLE);
+    Comparator_setHoldoff(2 * 1000UL * ICP_TICKS_PER_US);
+    Comparator_onEdge(crossing);
+
+    unsigned long lastEdges = 0;
+    unsigned long lastReport = 0;
+    while (1) {
+        if (uptimeMs() - lastReport >= 1000) {
+            lastReport += 1000;
+
+            unsigned long edges = Comparator_edges();
+            if (edges == lastEdges) {
+                Serial_println_P(PSTR("no signal"));
+            } else {
+                unsigned long frequency = Comparator_frequency();
+                uint16_t degrees = ((unsigned long)Comparator_phase(ICP_now()) * 360) >> 16;
+                Serial_printf_P(PSTR("%lu.%02lu Hz, %lu crossings, phase %u deg\n"), frequency / 100,
+                                frequency % 100, edges - lastEdges, degrees);
+            }
+            lastEdges = edges;
+        }
+
+        sleep(1);
+    }
+
+    return 0;
+}
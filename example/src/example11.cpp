@@ -0,0 +1,63 @@
+/**
+ *  @file example11.cpp
+ *  @brief Deferred work: interrupt callbacks hand their slow parts to the main loop
+ *
+ *  This program watches zero crossings with the analog comparator like example10, but the interrupt
+ *  callback only posts work items. The LED update runs at high priority; the serial report is posted
+ *  at low priority with WORK_COALESCE, so crossings that arrive while a report is still pending do not
+ *  queue more reports. Items run from sleep() in the main loop, which prints the queue statistics.
+ *
+ *  @details
+ *  - AC signal on AIN0 (D6) against its bias on AIN1 (D7), LED on D13.
+ *  - Output at 115200 baud: a report line per handled crossing batch and the statistics every 5 s.
+ */
+
+#include "AVRLite.h"
+#include "Comparator.h"
+#include "Work.h"
+
+static volatile unsigned long crossings;
+
+static void showLevel(uint16_t level) {
+    GPIOWrite(D13, level ? HIGH : LOW);
+}
+
+static void report(uint16_t) {
+    // Printing takes far longer than the interrupt may
+    Serial_printf_P(PSTR("%lu crossings, %lu.%02lu Hz\n"), crossings, Comparator_frequency() / 100,
+                    Comparator_frequency() % 100);
+}
+
+// Runs in the comparator interrupt: count and post, nothing slow
+static void crossing(uint8_t level) {
+    crossings++;
+    Work_post(showLevel, level, WORK_HIGH);
+    Work_post(report, 0, WORK_LOW | WORK_COALESCE);
+}
+
+int main() {
+    Serial_begin<115200>();
+    GPIOInit(D13, OUTPUT);
+
+    Comparator_begin(D6, D7, COMPARATOR_TOGGLE);
+    Comparator_setHoldoff(2000 * ICP_TICKS_PER_US);
+    Comparator_onEdge(crossing);
+
+    unsigned long lastStats = 0;
+    while (1) {
+        if (uptimeMs() - lastStats >= 5000) {
+            lastStats += 5000;
+            Work_Stats stats;
+            Work_stats(&stats);
+            Serial_printf_P(PSTR("work: %lu posted, %lu run, %u coalesced, %u dropped, depth %u, "
+                                 "wait %lu us mean %lu us max\n"),
+                            stats.posted, stats.run, stats.coalesced, stats.dropped, stats.maxDepth,
+                            stats.meanWaitUs, stats.maxWaitUs);
+        }
+
+        // Pending work runs here before the CPU idles
+        sleep(1);
+    }
+
+    return 0;
+}
@@ -52,8 +52,8 @@ int main() {
     Serial_begin(9600);
 
     // Send a test message to the serial monitor
-    Serial_print("Hello ");
-    Serial_println("world");
+    Serial_print(F("Hello "));
+    Serial_println(F("world"));
 
     // Set the pins for LED_1, LED_2, and LED_3 to OUTPUT mode
     GPIOControl(LED_1, OUTPUT);  // or GPIOInit(LED_1, OUTPUT);
@@ -76,7 +76,7 @@ int main() {
             int readState3 = pwmLED;
 
             // Output the state of the LEDs to the serial monitor
-            Serial_printf("LED 1: %d, LED 2: %d, LED 3: %d\n", readState1, readState2, readState3);
+            Serial_printf(F("LED 1: %d, LED 2: %d, LED 3: %d\n"), readState1, readState2, readState3);
         }
 
         // Toggle the state of LED_1 every 5000 milliseconds (5 seconds)
@@ -0,0 +1,35 @@
+/**
+ *  @file example7.cpp
+ *  @brief Binary telemetry stream of analog readings at 1 Mbaud
+ *
+ *  This program samples A0 and A1 and streams them as COBS-framed binary telemetry records,
+ *  together with the loop counter. Decode on the host with tools/telemetry_decode.
+ *
+ *  @details
+ *  - Serial runs at 1000000 baud (exact at 16 MHz).
+ *  - Frames are dropped instead of stalling the loop when the transmit buffer is full.
+ */
+
+#include "AVRLite.h"
+#include "Telemetry.h"
+
+int main() {
+    // 1 Mbaud, checked at compile time
+    Serial_begin<1000000>();
+
+    // Drop frames when the transmit buffer is full, never stall the loop
+    Telemetry_begin(TELEMETRY_DROP);
+
+    uint32_t loops = 0;
+    while (1) {
+        Telemetry_startFrame();
+        Telemetry_addU16(0, GPIORead(A0, ANALOGREAD));
+        Telemetry_addU16(1, GPIORead(A1, ANALOGREAD));
+        Telemetry_addU32(2, loops++);
+        Telemetry_send();
+
+        sleep(1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,6 @@
+# Commands of example8.cpp: name, argument types (i u q s, - for none), handler
+led     u    cmd_led
+pwm     uu   cmd_pwm
+gain    q    cmd_gain
+name    s    cmd_name
+status  -    cmd_status
@@ -0,0 +1,81 @@
+/**
+ *  @file example8.cpp
+ *  @brief Serial configuration commands with a flash-resident command table
+ *
+ *  This program takes text commands over the serial port while the main loop keeps blinking an LED.
+ *  The commands are listed in example8.cmd; the build turns them into a perfect-hash table in flash
+ *  (example8_commands.h, generated by tools/command_table.py).
+ *
+ *  @details
+ *  - Serial runs at 115200 baud, lines end with CR and/or LF.
+ *  - led <0|1>, pwm <pin> <duty>, gain <fraction>, name <text|"quoted text">, status
+ *  - Unknown commands and bad arguments are answered with "ERR ...".
+ */
+
+#include "AVRLite.h"
+#include "Command.h"
+#include "FixedPoint.h"
+#include "example8_commands.h"
+
+#define LED_STATUS D13
+#define LED_USER   D12
+
+static q16_16_t gain = Q16_16(1.0);
+static char name[16] = "avrlite";
+
+void cmd_led(const Command_Arg *args) {
+    GPIOWrite(LED_USER, args[0].u ? HIGH : LOW);
+    Serial_println(F("OK"));
+}
+
+void cmd_pwm(const Command_Arg *args) {
+    // Hardware PWM on Timer0/Timer2 pins, D9/D10 are switched by the Timer1 compare B interrupt
+    uint32_t pin = args[0].u;
+    if ((pin != D3 && pin != D5 && pin != D6 && pin != D9 && pin != D10 && pin != D11) || args[1].u > 255) {
+        Serial_println(F("ERR pin"));
+        return;
+    }
+    GPIOInit(pin, OUTPUT);
+    GPIOWrite(pin, ANALOGWRITE, args[1].u);
+    Serial_println(F("OK"));
+}
+
+void cmd_gain(const Command_Arg *args) {
+    gain = args[0].q;
+    Serial_println(F("OK"));
+}
+
+void cmd_name(const Command_Arg *args) {
+    // The argument points into the line buffer, keep a copy
+    strncpy(name, args[0].s, sizeof(name) - 1);
+    Serial_println(F("OK"));
+}
+
+void cmd_status(const Command_Arg *args) {
+    (void)args;
+    long milli = ((int64_t)gain * 1000 + 0x8000) >> 16;
+    Serial_printf(F("%s: up %lu ms, gain %ld/1000, %lu bytes lost\n"), name, uptimeMs(), milli, Command_overruns());
+}
+
+int main() {
+    Serial_begin<115200>();
+    Command_begin(&command_table, COMMAND_REPORT);
+
+    GPIOInit(LED_STATUS, OUTPUT);
+    GPIOInit(LED_USER, OUTPUT);
+
+    unsigned long lastBlink = 0;
+    uint8_t led = LOW;
+    while (1) {
+        // At most COMMAND_POLL_BYTES bytes and one command per pass
+        Command_poll();
+
+        if (uptimeMs() - lastBlink >= 500) {
+            lastBlink += 500;
+            led = !led;
+            GPIOWrite(LED_STATUS, led);
+        }
+    }
+
+    return 0;
+}
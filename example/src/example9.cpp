@@ -0,0 +1,53 @@
+/**
+ *  @file example9.cpp
+ *  @brief Multiplexed 4-digit 7-segment display and 4x4 keypad, scanned by Timer2
+ *
+ *  This program counts seconds on a 4-digit display and shows the number of the last key pressed on
+ *  a 4x4 keypad. The Timer2 interrupt lights one digit per tick and reads the keypad columns on the
+ *  same digit lines, so the display never flickers while the main loop is busy.
+ *
+ *  @details
+ *  - Segments a-g and dp on D0-D7 (one port store per digit, Serial is not used).
+ *  - Common cathode digits on D8-D11, selected LOW; they are also the keypad rows.
+ *  - Keypad columns on A0-A3 with the internal pull-ups.
+ *  - 100 frames per second, 400 row ticks per second.
+ */
+
+#include "AVRLite.h"
+#include "Scan.h"
+
+static const uint8_t digits[4] = {D8, D9, D10, D11};
+static const uint8_t segments[8] = {D0, D1, D2, D3, D4, D5, D6, D7};
+static const uint8_t columns[4] = {A0, A1, A2, A3};
+
+int main() {
+    Scan_begin(digits, 4, segments, 8, SCAN_ROW_ACTIVE_LOW, 100);
+    Scan_keypad(columns, 4);
+
+    char text[8];
+    int8_t lastKey = -1;
+    unsigned long lastUpdate = 0;
+    while (1) {
+        uint8_t event;
+        while (Scan_readKey(&event)) {
+            if (!(event & SCAN_KEY_RELEASED))
+                lastKey = event;
+        }
+
+        // Redraw four times a second, in the back buffer while the front one is shown
+        if (uptimeMs() - lastUpdate >= 250 && Scan_ready()) {
+            lastUpdate += 250;
+            unsigned int seconds = uptimeMs() / 1000;
+            if (lastKey < 0)
+                snprintf(text, sizeof(text), "%4u", seconds % 10000);
+            else
+                snprintf(text, sizeof(text), "%2u.%2d", seconds % 100, lastKey);
+            Scan_print(text);
+            Scan_swap();
+        }
+
+        sleep(1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,1038 @@
+#include "AVRHost.h"
+#include <avr/io.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef F_CPU
+#error "F_CPU must be defined for the host build"
+#endif
+
+#define HOST_NEVER UINT64_MAX
+#define HOST_SCHEDULE_SIZE 32
+#define HOST_RX_BUFFER_SIZE 256
+
+// Interrupt vectors, weak so only the handlers the firmware defines are linked in
+extern "C" {
+void __vector_1(void) __attribute__((weak));
+void __vector_2(void) __attribute__((weak));
+void __vector_3(void) __attribute__((weak));
+void __vector_4(void) __attribute__((weak));
+void __vector_5(void) __attribute__((weak));
+void __vector_6(void) __attribute__((weak));
+void __vector_7(void) __attribute__((weak));
+void __vector_8(void) __attribute__((weak));
+void __vector_9(void) __attribute__((weak));
+void __vector_10(void) __attribute__((weak));
+void __vector_11(void) __attribute__((weak));
+void __vector_12(void) __attribute__((weak));
+void __vector_13(void) __attribute__((weak));
+void __vector_14(void) __attribute__((weak));
+void __vector_15(void) __attribute__((weak));
+void __vector_16(void) __attribute__((weak));
+void __vector_17(void) __attribute__((weak));
+void __vector_18(void) __attribute__((weak));
+void __vector_19(void) __attribute__((weak));
+void __vector_20(void) __attribute__((weak));
+void __vector_21(void) __attribute__((weak));
+void __vector_22(void) __attribute__((weak));
+void __vector_23(void) __attribute__((weak));
+void __vector_24(void) __attribute__((weak));
+void __vector_25(void) __attribute__((weak));
+}
+
+static void (*const host_vectors[26])(void) = {
+    NULL, __vector_1, __vector_2, __vector_3, __vector_4, __vector_5, __vector_6, __vector_7,
+    __vector_8, __vector_9, __vector_10, __vector_11, __vector_12, __vector_13, __vector_14,
+    __vector_15, __vector_16, __vector_17, __vector_18, __vector_19, __vector_20, __vector_21,
+    __vector_22, __vector_23, __vector_24, __vector_25,
+};
+
+// Register file, indexed by data-space address
+static uint8_t io[0x100];
+#define IO(reg) io[_SFR_MEM_ADDR(reg)]
+
+static uint64_t host_now;                    // Virtual clock
+static uint64_t host_next_event;             // Earliest cycle something has to happen
+static uint64_t host_limit = HOST_NEVER;     // AVRLITE_HOST_SECONDS
+static uint8_t host_stopped;                 // Deep sleep, the peripheral clocks are off
+static uint32_t host_dispatched;             // Interrupts run so far, ends a sleep
+static uint8_t host_temp;                    // TEMP register of the 16-bit Timer1 accesses
+static uint8_t host_trace;                   // AVRLITE_HOST_TRACE
+
+static Host_PinHook host_pin_hook;
+static Host_PwmHook host_pwm_hook;
+static Host_SerialHook host_serial_hook;
+static Host_SpiHook host_spi_hook;
+static Host_AdcHook host_adc_hook;
+
+// Timers: prescaler tables indexed by the CS bits
+static const uint16_t host_prescaler01[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+static const uint16_t host_prescaler2[8] = {0, 1, 8, 32, 64, 128, 256, 1024};
+
+struct __HostTimer__ {
+    uint8_t tccra, tccrb, tcnt, ocra, ocrb, tifr, prr;
+    uint8_t wide;                // Timer1: 16-bit registers
+    const uint16_t *prescalers;
+    uint16_t count;
+    uint32_t phase;              // CPU cycles into the current timer tick
+    uint64_t synced;             // Cycle `count` is valid at
+    uint64_t next;               // Next cycle a flag is set
+};
+
+static __HostTimer__ host_timers[3] = {
+    {0x44, 0x45, 0x46, 0x47, 0x48, 0x35, PRTIM0, 0, host_prescaler01, 0, 0, 0, HOST_NEVER},
+    {0x80, 0x81, 0x84, 0x88, 0x8A, 0x36, PRTIM1, 1, host_prescaler01, 0, 0, 0, HOST_NEVER},
+    {0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0x37, PRTIM2, 0, host_prescaler2, 0, 0, 0, HOST_NEVER},
+};
+
+// Peripheral state
+static uint64_t host_adc_done = HOST_NEVER;
+static uint8_t host_adc_first = 1;
+static uint16_t host_analog[8];
+static uint64_t host_spi_done = HOST_NEVER;
+static uint8_t host_spi_data;
+static uint64_t host_tx_end = HOST_NEVER;
+static uint8_t host_tx_pending, host_tx_data;
+static uint8_t host_rx[HOST_RX_BUFFER_SIZE];
+static uint16_t host_rx_head, host_rx_count;
+static uint64_t host_rx_ready;
+static uint8_t host_eeprom[E2END + 1];
+static uint64_t host_ee_done = HOST_NEVER;
+static uint64_t host_eempe_at;
+static uint64_t host_wdt_due = HOST_NEVER;
+static uint8_t host_levels[3], host_input[3], host_driven[3];
+static uint32_t host_pwm_state[6];
+
+struct __HostScheduled__ {
+    uint64_t cycle;
+    Host_Event event;
+};
+static __HostScheduled__ host_schedule[HOST_SCHEDULE_SIZE];
+static uint8_t host_schedule_count;
+
+// Ports in AVRLite pin order: B = D8-D13, C = A0-A5, D = D0-D7
+static const uint8_t host_port_pin[3] = {8, 14, 0};
+
+static void __HostReschedule__();
+static void __HostPoll__();
+
+/* ---------------------------------------------------------------- timers */
+
+static uint32_t __HostTimerPrescaler__(const __HostTimer__ &t) {
+    if (io[_SFR_MEM_ADDR(PRR)] & (1 << t.prr))
+        return 0;
+    return t.prescalers[io[t.tccrb] & 0x07];
+}
+
+// Counter top for the waveform mode, `ctc` is set when the overflow flag only fires at MAX
+static uint16_t __HostTimerTop__(const __HostTimer__ &t, uint8_t &ctc) {
+    ctc = 0;
+    if (!t.wide) {
+        uint8_t wgm = (io[t.tccra] & 0x03) | ((io[t.tccrb] >> WGM02) & 1) << 2;
+        if (wgm == 2)
+            ctc = 1;
+        return (wgm == 2 || wgm == 5 || wgm == 7) ? io[t.ocra] : 0xFF;
+    }
+
+    uint8_t wgm = (io[t.tccra] & 0x03) | ((io[t.tccrb] >> WGM12) & 0x03) << 2;
+    uint16_t ocr1a = io[t.ocra] | io[t.ocra + 1] << 8;
+    uint16_t icr1 = IO(ICR1L) | IO(ICR1H) << 8;
+    switch (wgm) {
+        case 1: case 5: return 0xFF;
+        case 2: case 6: return 0x1FF;
+        case 3: case 7: return 0x3FF;
+        case 4: ctc = 1; return ocr1a;
+        case 12: ctc = 1; return icr1;
+        case 8: case 10: case 14: return icr1;
+        case 9: case 11: case 15: return ocr1a;
+    }
+    return 0xFFFF;
+}
+
+static uint16_t __HostTimerCompare__(const __HostTimer__ &t, uint8_t address) {
+    return t.wide ? (io[address] | io[address + 1] << 8) : io[address];
+}
+
+// Bring the counter up to the current cycle, setting the flags it passes
+static void __HostTimerSync__(__HostTimer__ &t) {
+    uint64_t elapsed = host_now - t.synced;
+    t.synced = host_now;
+    uint32_t prescaler = __HostTimerPrescaler__(t);
+    if (!prescaler || host_stopped) {
+        t.next = HOST_NEVER;
+        return;
+    }
+
+    uint64_t total = t.phase + elapsed;
+    uint64_t ticks = total / prescaler;
+    t.phase = total % prescaler;
+
+    uint16_t max = t.wide ? 0xFFFF : 0xFF;
+    uint16_t ocra = __HostTimerCompare__(t, t.ocra), ocrb = __HostTimerCompare__(t, t.ocrb);
+    uint8_t ctc;
+    uint16_t top = __HostTimerTop__(t, ctc);
+
+    while (1) {
+        // A counter written above top runs on to MAX first
+        uint16_t lapTop = t.count > top ? max : top;
+        uint32_t distance = (uint32_t)lapTop + 1 - t.count;
+        if (ocra > t.count && ocra <= lapTop && (uint32_t)(ocra - t.count) < distance)
+            distance = ocra - t.count;
+        if (ocrb > t.count && ocrb <= lapTop && (uint32_t)(ocrb - t.count) < distance)
+            distance = ocrb - t.count;
+
+        if (ticks < distance) {
+            t.count += (uint16_t)ticks;
+            t.next = host_now + (distance - ticks) * prescaler - t.phase;
+            return;
+        }
+
+        ticks -= distance;
+        if (t.count + distance > lapTop) {
+            t.count = 0;
+            if (!ctc || lapTop == max)
+                io[t.tifr] |= (1 << TOV0);
+        } else {
+            t.count += distance;
+        }
+        if (t.count == ocra)
+            io[t.tifr] |= (1 << OCF0A);
+        if (t.count == ocrb)
+            io[t.tifr] |= (1 << OCF0B);
+        // Timer1 with ICR1 as top flags the capture interrupt there
+        if (t.wide && t.count == top && top == (uint16_t)(IO(ICR1L) | IO(ICR1H) << 8) && (io[t.tccrb] & (1 << WGM13)))
+            io[t.tifr] |= (1 << ICF1);
+    }
+}
+
+static void __HostTimersSync__() {
+    for (uint8_t i = 0; i < 3; i++)
+        __HostTimerSync__(host_timers[i]);
+}
+
+/* ---------------------------------------------------------------- pins */
+
+static const char *__HostPinName__(uint8_t pin) {
+    static char name[8];
+    if (pin >= 14)
+        snprintf(name, sizeof(name), "A%u", pin - 14);
+    else
+        snprintf(name, sizeof(name), "D%u", pin);
+    return name;
+}
+
+struct __HostPwmPin__ {
+    uint8_t timer, com, ocr, pin;
+};
+
+// OC0A = D6, OC0B = D5, OC1A = D9, OC1B = D10, OC2A = D11, OC2B = D3
+static const __HostPwmPin__ host_pwm_pins[6] = {
+    {0, COM0A1, 0x47, 6}, {0, COM0B1, 0x48, 5}, {1, COM1A1, 0x88, 9},
+    {1, COM1B1, 0x8A, 10}, {2, COM2A1, 0xB3, 11}, {2, COM2B1, 0xB4, 3},
+};
+
+// Report PWM outputs whose compare value, top or connection changed
+static void __HostPwmUpdate__() {
+    if (!host_pwm_hook && !host_trace)
+        return;
+
+    for (uint8_t i = 0; i < 6; i++) {
+        const __HostPwmPin__ &p = host_pwm_pins[i];
+        const __HostTimer__ &t = host_timers[p.timer];
+        uint16_t value = 0, top = 0;
+        if ((io[t.tccra] & (1 << p.com)) && __HostTimerPrescaler__(t)) {
+            uint8_t ctc;
+            value = __HostTimerCompare__(t, p.ocr);
+            top = __HostTimerTop__(t, ctc);
+        }
+
+        uint32_t state = (uint32_t)value << 16 | top;
+        if (state == host_pwm_state[i])
+            continue;
+        host_pwm_state[i] = state;
+        if (host_pwm_hook)
+            host_pwm_hook(host_now, p.pin, value, top);
+        if (host_trace) {
+            if (top)
+                fprintf(stderr, "%12.6f %-3s pwm %u/%u\n", Host_seconds(), __HostPinName__(p.pin), value, top);
+            else
+                fprintf(stderr, "%12.6f %-3s pwm off\n", Host_seconds(), __HostPinName__(p.pin));
+        }
+    }
+}
+
+// Input capture on ICP1 (D8) with the edge selected by ICES1
+static void __HostCapture__(uint8_t level) {
+    if (level != ((IO(TCCR1B) >> ICES1) & 1))
+        return;
+    __HostTimerSync__(host_timers[1]);
+    IO(ICR1L) = host_timers[1].count & 0xFF;
+    IO(ICR1H) = host_timers[1].count >> 8;
+    IO(TIFR1) |= (1 << ICF1);
+}
+
+// Analog comparator output (ACO), driven by Host_setComparator while ACD is clear
+static uint8_t host_comparator;
+
+static void __HostComparator__() {
+    uint8_t acsr = IO(ACSR);
+    uint8_t level = (acsr & (1 << ACD)) ? 0 : host_comparator;
+    if (level == ((acsr >> ACO) & 1))
+        return;
+
+    // ACIS1:0 = toggle, (reserved), falling, rising
+    acsr = (acsr & ~(1 << ACO)) | (level << ACO);
+    uint8_t sense = acsr & ((1 << ACIS1) | (1 << ACIS0));
+    if (sense == 0 || (sense == 2 && !level) || (sense == 3 && level))
+        acsr |= (1 << ACI);
+    IO(ACSR) = acsr;
+    // ACIC replaces ICP1 with the comparator output
+    if (acsr & (1 << ACIC))
+        __HostCapture__(level);
+}
+
+// External interrupt INT0 (D2) or INT1 (D3), sense selected by EICRA
+static void __HostExternal__(uint8_t n, uint8_t level) {
+    uint8_t sense = (IO(EICRA) >> (2 * n)) & 0x03;
+    if (sense == 1 || (sense == 2 && !level) || (sense == 3 && level) || (sense == 0 && !level))
+        IO(EIFR) |= (1 << n);
+}
+
+// Recompute the levels of a port (0 = B, 1 = C, 2 = D) after a register write or a host input
+static void __HostPinsChanged__(uint8_t port) {
+    uint8_t pinAddress = 0x23 + 3 * port;
+    uint8_t ddr = io[pinAddress + 1], out = io[pinAddress + 2];
+    uint8_t pullup = (IO(MCUCR) & (1 << PUD)) ? 0 : out;
+    uint8_t level = (ddr & out) | (~ddr & ((host_driven[port] & host_input[port]) | (~host_driven[port] & pullup)));
+    if (port == 1)
+        level &= 0x7F;  // PC6 is RESET
+
+    uint8_t changed = level ^ host_levels[port];
+    if (!changed)
+        return;
+    host_levels[port] = level;
+    io[pinAddress] = level;
+
+    // Pin change interrupts: PCMSK0-2 follow the port order B, C, D
+    if (changed & io[_SFR_MEM_ADDR(PCMSK0) + port])
+        IO(PCIFR) |= (1 << port);
+    if (port == 0 && (changed & 0x01) && !(IO(ACSR) & (1 << ACIC)))
+        __HostCapture__(level & 0x01);
+    if (port == 2 && (changed & 0x04))
+        __HostExternal__(0, (level >> 2) & 1);
+    if (port == 2 && (changed & 0x08))
+        __HostExternal__(1, (level >> 3) & 1);
+
+    for (uint8_t bit = 0; bit < 8; bit++) {
+        if (!(changed & (1 << bit)))
+            continue;
+        uint8_t pin = host_port_pin[port] + bit, value = (level >> bit) & 1;
+        if (host_pin_hook)
+            host_pin_hook(host_now, pin, value);
+        if (host_trace)
+            fprintf(stderr, "%12.6f %-3s %u\n", Host_seconds(), __HostPinName__(pin), value);
+    }
+}
+
+static uint8_t __HostPinPort__(uint8_t pin, uint8_t &bit) {
+    if (pin < 8) {
+        bit = pin;
+        return 2;
+    }
+    if (pin < 14) {
+        bit = pin - 8;
+        return 0;
+    }
+    bit = pin - 14;
+    return 1;
+}
+
+/* ---------------------------------------------------------------- peripherals */
+
+// Frame length of USART0 in CPU cycles
+static uint64_t __HostFrameCycles__() {
+    uint8_t control = IO(UCSR0C);
+    uint8_t bits = 1 + 5 + ((control >> UCSZ00) & 0x03) + ((IO(UCSR0B) & (1 << UCSZ02)) ? 4 : 0);
+    bits += ((control >> UPM00) & 0x03) ? 1 : 0;
+    bits += (control & (1 << USBS0)) ? 2 : 1;
+    uint16_t ubrr = IO(UBRR0L) | (IO(UBRR0H) & 0x0F) << 8;
+    return (uint64_t)bits * (ubrr + 1) * ((IO(UCSR0A) & (1 << U2X0)) ? 8 : 16);
+}
+
+static void __HostTransmit__(uint8_t data) {
+    if (host_serial_hook)
+        host_serial_hook(host_now, data);
+    else
+        fputc(data, stdout);
+    host_tx_end = (host_tx_end == HOST_NEVER ? host_now : host_tx_end) + __HostFrameCycles__();
+}
+
+static uint8_t __HostRxReady__() {
+    return host_rx_count && host_now >= host_rx_ready && (IO(UCSR0B) & (1 << RXEN0));
+}
+
+static void __HostAdcStart__(uint8_t cycles) {
+    static const uint8_t prescalers[8] = {2, 2, 4, 8, 16, 32, 64, 128};
+    host_adc_done = host_now + (uint64_t)cycles * prescalers[IO(ADCSRA) & 0x07];
+    IO(ADCSRA) |= (1 << ADSC);
+}
+
+static void __HostAdcComplete__() {
+    uint8_t channel = IO(ADMUX) & 0x0F;
+    uint16_t value;
+    if (host_adc_hook)
+        value = host_adc_hook(host_now, channel);
+    else if (channel < 8)
+        value = host_analog[channel];
+    else
+        value = (channel == 14) ? 225 : 0;  // 1.1 V bandgap against 5 V, or GND
+    if (value > 1023)
+        value = 1023;
+    if (IO(ADMUX) & (1 << ADLAR))
+        value <<= 6;
+
+    IO(ADCL) = value & 0xFF;
+    IO(ADCH) = value >> 8;
+    IO(ADCSRA) = (IO(ADCSRA) & ~(1 << ADSC)) | (1 << ADIF);
+    host_adc_first = 0;
+    host_adc_done = HOST_NEVER;
+    // Free running mode starts the next conversion right away
+    if ((IO(ADCSRA) & (1 << ADATE)) && !(IO(ADCSRB) & 0x07))
+        __HostAdcStart__(13);
+}
+
+static uint64_t __HostWatchdogPeriod__() {
+    uint8_t control = IO(WDTCSR);
+    uint8_t prescale = (control & 0x07) | ((control >> WDP3) & 1) << 3;
+    if (prescale > 9)
+        prescale = 9;
+    // 128 kHz watchdog oscillator, 2K cycles at WDTO_15MS
+    return ((uint64_t)2048 << prescale) * F_CPU / 128000;
+}
+
+extern "C" void __HostWatchdogReset__(void) {
+    host_wdt_due = (IO(WDTCSR) & ((1 << WDE) | (1 << WDIE))) ? host_now + __HostWatchdogPeriod__() : HOST_NEVER;
+    __HostReschedule__();
+}
+
+/* ---------------------------------------------------------------- registers */
+
+static uint8_t __HostLoad__(uint8_t address) {
+    switch (address) {
+        case 0x46:
+        case 0xB2: {
+            __HostTimer__ &t = host_timers[address == 0x46 ? 0 : 2];
+            __HostTimerSync__(t);
+            return t.count;
+        }
+        case 0x84:
+            __HostTimerSync__(host_timers[1]);
+            host_temp = host_timers[1].count >> 8;
+            return host_timers[1].count & 0xFF;
+        case 0x86:
+            host_temp = IO(ICR1H);
+            return IO(ICR1L);
+        case 0x85:
+        case 0x87:
+            return host_temp;
+        case 0x3F:
+            // EEMPE clears itself after four cycles
+            if ((IO(EECR) & (1 << EEMPE)) && host_now - host_eempe_at > 4)
+                IO(EECR) &= ~(1 << EEMPE);
+            return IO(EECR);
+        case 0x4E:
+            IO(SPSR) &= ~(1 << SPIF);
+            return IO(SPDR);
+        case 0xC0:
+            return (IO(UCSR0A) & ((1 << TXC0) | (1 << U2X0) | (1 << MPCM0)))
+                | (host_tx_pending ? 0 : (1 << UDRE0)) | (__HostRxReady__() ? (1 << RXC0) : 0);
+        case 0xC6:
+            if (__HostRxReady__()) {
+                IO(UDR0) = host_rx[host_rx_head];
+                host_rx_head = (host_rx_head + 1) % HOST_RX_BUFFER_SIZE;
+                host_rx_count--;
+                host_rx_ready += __HostFrameCycles__();
+                if (host_rx_ready < host_now)
+                    host_rx_ready = host_now;
+                __HostReschedule__();
+            }
+            return IO(UDR0);
+    }
+    return io[address];
+}
+
+static void __HostStore__(uint8_t address, uint8_t value) {
+    uint8_t old = io[address];
+    switch (address) {
+        case 0x23: case 0x26: case 0x29:
+            // Writing PINx toggles PORTx
+            io[address + 2] ^= value;
+            __HostPinsChanged__((address - 0x23) / 3);
+            return;
+        case 0x24: case 0x25: case 0x27: case 0x28: case 0x2A: case 0x2B:
+            io[address] = value;
+            __HostPinsChanged__((address - 0x24) / 3);
+            return;
+        case 0x55:
+            io[address] = value;
+            for (uint8_t port = 0; port < 3; port++)
+                __HostPinsChanged__(port);
+            return;
+
+        // Interrupt flags are cleared by writing a one
+        case 0x35: case 0x36: case 0x37: case 0x3B: case 0x3C:
+            __HostTimersSync__();
+            io[address] = old & ~value;
+            break;
+
+        case 0x44: case 0x45: case 0x46: case 0x47: case 0x48:
+        case 0xB0: case 0xB1: case 0xB2: case 0xB3: case 0xB4: {
+            __HostTimer__ &t = host_timers[address < 0xB0 ? 0 : 2];
+            __HostTimerSync__(t);
+            if (address == t.tcnt)
+                t.count = value;
+            else
+                io[address] = value;
+            __HostTimerSync__(t);
+            __HostPwmUpdate__();
+            break;
+        }
+
+        // Timer1: the high byte goes to TEMP, the low byte write updates both
+        case 0x85: case 0x87: case 0x89: case 0x8B:
+            host_temp = value;
+            return;
+        case 0x80: case 0x81: case 0x82: case 0x84: case 0x86: case 0x88: case 0x8A: {
+            __HostTimer__ &t = host_timers[1];
+            __HostTimerSync__(t);
+            if (address == 0x84) {
+                t.count = host_temp << 8 | value;
+            } else {
+                io[address] = value;
+                if (address >= 0x86)
+                    io[address + 1] = host_temp;
+            }
+            __HostTimerSync__(t);
+            __HostPwmUpdate__();
+            break;
+        }
+
+        case 0x64:
+            __HostTimersSync__();
+            io[address] = value;
+            __HostTimersSync__();
+            __HostPwmUpdate__();
+            break;
+
+        case 0x3F: {
+            uint8_t control = __HostLoad__(address);
+            io[address] = (value & ((1 << EERIE) | (1 << EEPM0) | (1 << EEPM1) | (1 << EEMPE))) | (control & (1 << EEPE));
+            if ((value & (1 << EEMPE)) && !(control & (1 << EEMPE)))
+                host_eempe_at = host_now;
+            uint16_t ee = (IO(EEARL) | IO(EEARH) << 8) & E2END;
+            if ((value & (1 << EEPE)) && (control & (1 << EEMPE)) && !(control & (1 << EEPE))) {
+                uint8_t mode = (value >> EEPM0) & 0x03;
+                if (mode == 0)
+                    host_eeprom[ee] = IO(EEDR);
+                else if (mode == 1)
+                    host_eeprom[ee] = 0xFF;
+                else if (mode == 2)
+                    host_eeprom[ee] &= IO(EEDR);
+                host_ee_done = host_now + (mode == 0 ? F_CPU * 34ULL / 10000 : F_CPU * 18ULL / 10000);
+                IO(EECR) = (IO(EECR) & ~(1 << EEMPE)) | (1 << EEPE);
+            } else if ((value & (1 << EERE)) && !(control & (1 << EEPE))) {
+                IO(EEDR) = host_eeprom[ee];
+            }
+            break;
+        }
+
+        case 0x4D:
+            io[address] = (old & ~(1 << SPI2X)) | (value & (1 << SPI2X));
+            break;
+        case 0x4E: {
+            IO(SPSR) &= ~(1 << SPIF);
+            if (!(IO(SPCR) & (1 << SPE))) {
+                io[address] = value;
+                break;
+            }
+            if (host_spi_done != HOST_NEVER) {
+                IO(SPSR) |= (1 << WCOL);
+                break;
+            }
+            static const uint8_t dividers[4] = {4, 16, 64, 128};
+            uint8_t divider = dividers[IO(SPCR) & 0x03] >> (IO(SPSR) & (1 << SPI2X) ? 1 : 0);
+            host_spi_data = host_spi_hook ? host_spi_hook(host_now, value) : 0xFF;
+            host_spi_done = host_now + 8 * divider;
+            break;
+        }
+
+        case 0x60:
+            io[address] = (value & ~(1 << WDIF)) | (old & (1 << WDIF) & ~value);
+            __HostWatchdogReset__();
+            break;
+
+        case 0x7A:
+            io[address] = (value & ~(1 << ADIF)) | (old & (1 << ADIF) & ~value) | (old & (1 << ADSC));
+            if (!(value & (1 << ADEN))) {
+                IO(ADCSRA) &= ~(1 << ADSC);
+                host_adc_done = HOST_NEVER;
+                host_adc_first = 1;
+            } else if ((value & (1 << ADSC)) && host_adc_done == HOST_NEVER) {
+                __HostAdcStart__(host_adc_first ? 25 : 13);
+            }
+            break;
+
+        case 0xC0:
+            io[address] = (value & ((1 << U2X0) | (1 << MPCM0))) | (old & (1 << TXC0) & ~value);
+            break;
+
+        // ACO is read-only, ACI is cleared by writing a one
+        case 0x50:
+            io[address] = (value & ~((1 << ACO) | (1 << ACI))) | (old & (1 << ACO)) | (old & (1 << ACI) & ~value);
+            __HostComparator__();
+            break;
+        case 0xC6:
+            if (!(IO(UCSR0B) & (1 << TXEN0)))
+                break;
+            if (host_tx_end == HOST_NEVER) {
+                __HostTransmit__(value);
+            } else if (!host_tx_pending) {
+                host_tx_pending = 1;
+                host_tx_data = value;
+            }
+            break;
+
+        default:
+            io[address] = value;
+            return;
+    }
+    __HostReschedule__();
+}
+
+/* ---------------------------------------------------------------- clock and interrupts */
+
+static void __HostReschedule__() {
+    uint64_t next = host_limit;
+    if (!host_stopped) {
+        for (uint8_t i = 0; i < 3; i++)
+            if (host_timers[i].next < next)
+                next = host_timers[i].next;
+        if (host_adc_done < next)
+            next = host_adc_done;
+        if (host_spi_done < next)
+            next = host_spi_done;
+        if (host_tx_end < next)
+            next = host_tx_end;
+        if (host_rx_count && host_rx_ready > host_now && host_rx_ready < next)
+            next = host_rx_ready;
+    }
+    if (host_ee_done < next)
+        next = host_ee_done;
+    if (host_wdt_due < next)
+        next = host_wdt_due;
+    for (uint8_t i = 0; i < host_schedule_count; i++)
+        if (host_schedule[i].cycle < next)
+            next = host_schedule[i].cycle;
+    host_next_event = next;
+}
+
+// Everything due at the current cycle
+static void __HostEvents__() {
+    if (host_now >= host_limit)
+        exit(0);
+
+    __HostTimersSync__();
+    if (host_now >= host_adc_done)
+        __HostAdcComplete__();
+    if (host_now >= host_spi_done) {
+        IO(SPDR) = host_spi_data;
+        IO(SPSR) |= (1 << SPIF);
+        host_spi_done = HOST_NEVER;
+    }
+    if (host_now >= host_tx_end) {
+        if (host_tx_pending) {
+            host_tx_pending = 0;
+            __HostTransmit__(host_tx_data);
+        } else {
+            host_tx_end = HOST_NEVER;
+            IO(UCSR0A) |= (1 << TXC0);
+        }
+    }
+    if (host_now >= host_ee_done) {
+        IO(EECR) &= ~(1 << EEPE);
+        host_ee_done = HOST_NEVER;
+    }
+    if (host_now >= host_wdt_due) {
+        if (IO(WDTCSR) & (1 << WDIE)) {
+            IO(WDTCSR) |= (1 << WDIF);
+            host_wdt_due = host_now + __HostWatchdogPeriod__();
+        } else {
+            fprintf(stderr, "avrlite-host: watchdog reset at %.6f s\n", Host_seconds());
+            exit(2);
+        }
+    }
+
+    for (uint8_t i = 0; i < host_schedule_count;) {
+        if (host_schedule[i].cycle > host_now) {
+            i++;
+            continue;
+        }
+        // Remove first, the event may schedule itself again
+        Host_Event event = host_schedule[i].event;
+        host_schedule[i] = host_schedule[--host_schedule_count];
+        event();
+    }
+    __HostReschedule__();
+}
+
+// Highest priority pending interrupt, 0 if none
+static uint8_t __HostPending__() {
+    if ((IO(EIFR) & IO(EIMSK)) & 0x03)
+        return (IO(EIFR) & IO(EIMSK) & 0x01) ? 1 : 2;
+    uint8_t pc = IO(PCIFR) & IO(PCICR) & 0x07;
+    if (pc)
+        return (pc & 0x01) ? 3 : (pc & 0x02) ? 4 : 5;
+    if ((IO(WDTCSR) & (1 << WDIF)) && (IO(WDTCSR) & (1 << WDIE)))
+        return 6;
+    uint8_t t2 = IO(TIFR2) & IO(TIMSK2) & 0x07;
+    if (t2)
+        return (t2 & (1 << OCF2A)) ? 7 : (t2 & (1 << OCF2B)) ? 8 : 9;
+    uint8_t t1 = IO(TIFR1) & IO(TIMSK1) & 0x27;
+    if (t1)
+        return (t1 & (1 << ICF1)) ? 10 : (t1 & (1 << OCF1A)) ? 11 : (t1 & (1 << OCF1B)) ? 12 : 13;
+    uint8_t t0 = IO(TIFR0) & IO(TIMSK0) & 0x07;
+    if (t0)
+        return (t0 & (1 << OCF0A)) ? 14 : (t0 & (1 << OCF0B)) ? 15 : 16;
+    if ((IO(SPSR) & (1 << SPIF)) && (IO(SPCR) & (1 << SPIE)))
+        return 17;
+    uint8_t usart = IO(UCSR0B);
+    if ((usart & (1 << RXCIE0)) && __HostRxReady__())
+        return 18;
+    if ((usart & (1 << UDRIE0)) && !host_tx_pending)
+        return 19;
+    if ((usart & (1 << TXCIE0)) && (IO(UCSR0A) & (1 << TXC0)))
+        return 20;
+    if ((IO(ADCSRA) & (1 << ADIF)) && (IO(ADCSRA) & (1 << ADIE)))
+        return 21;
+    if ((IO(EECR) & (1 << EERIE)) && !(IO(EECR) & (1 << EEPE)))
+        return 22;
+    if ((IO(ACSR) & (1 << ACI)) && (IO(ACSR) & (1 << ACIE)))
+        return 23;
+    return 0;
+}
+
+static void __HostDispatch__(uint8_t vector) {
+    // Flags the hardware clears when the vector is taken
+    switch (vector) {
+        case 1: case 2: IO(EIFR) &= ~(1 << (vector - 1)); break;
+        case 3: case 4: case 5: IO(PCIFR) &= ~(1 << (vector - 3)); break;
+        case 6:
+            IO(WDTCSR) &= ~(1 << WDIF);
+            // Interrupt and reset mode: the next timeout resets
+            if (IO(WDTCSR) & (1 << WDE))
+                IO(WDTCSR) &= ~(1 << WDIE);
+            break;
+        case 7: case 8: IO(TIFR2) &= ~(1 << (vector - 6)); break;
+        case 9: IO(TIFR2) &= ~(1 << TOV2); break;
+        case 10: IO(TIFR1) &= ~(1 << ICF1); break;
+        case 11: case 12: IO(TIFR1) &= ~(1 << (vector - 10)); break;
+        case 13: IO(TIFR1) &= ~(1 << TOV1); break;
+        case 14: case 15: IO(TIFR0) &= ~(1 << (vector - 13)); break;
+        case 16: IO(TIFR0) &= ~(1 << TOV0); break;
+        case 17: IO(SPSR) &= ~(1 << SPIF); break;
+        case 20: IO(UCSR0A) &= ~(1 << TXC0); break;
+        case 21: IO(ADCSRA) &= ~(1 << ADIF); break;
+        case 23: IO(ACSR) &= ~(1 << ACI); break;
+    }
+
+    if (!host_vectors[vector]) {
+        fprintf(stderr, "avrlite-host: interrupt %u has no handler, the device resets (%.6f s)\n", vector, Host_seconds());
+        exit(1);
+    }
+
+    // Waking from a deep sleep starts the peripheral clocks again
+    if (host_stopped) {
+        host_stopped = 0;
+        for (uint8_t i = 0; i < 3; i++)
+            host_timers[i].synced = host_now;
+        __HostTimersSync__();
+        __HostReschedule__();
+    }
+
+    host_dispatched++;
+    IO(SREG) &= ~(1 << SREG_I);
+    Host_advance(4);  // Vector call
+    host_vectors[vector]();
+    Host_advance(4);  // reti
+    IO(SREG) |= (1 << SREG_I);
+}
+
+static void __HostPoll__() {
+    while (IO(SREG) & (1 << SREG_I)) {
+        uint8_t vector = __HostPending__();
+        if (!vector)
+            return;
+        __HostDispatch__(vector);
+    }
+}
+
+void Host_advance(uint64_t cycles) {
+    uint64_t target = host_now + cycles;
+    while (host_next_event <= target) {
+        if (host_next_event > host_now)
+            host_now = host_next_event;
+        __HostEvents__();
+        // Interrupts stall the interrupted code
+        uint64_t before = host_now;
+        __HostPoll__();
+        target += host_now - before;
+    }
+    host_now = target;
+    __HostPoll__();
+}
+
+extern "C" void __HostSei__(void) {
+    IO(SREG) |= (1 << SREG_I);
+}
+
+extern "C" void __HostSleep__(void) {
+    if (!(IO(SMCR) & (1 << SE)))
+        return;
+    if (!(IO(SREG) & (1 << SREG_I))) {
+        if (host_trace)
+            fprintf(stderr, "avrlite-host: sleeping with interrupts disabled at %.6f s\n", Host_seconds());
+        exit(0);
+    }
+
+    uint32_t dispatched = host_dispatched;
+    __HostPoll__();
+    if (dispatched != host_dispatched)
+        return;
+
+    // Power-down, power-save and standby stop the timers and the peripherals
+    uint8_t mode = (IO(SMCR) >> SM0) & 0x07;
+    if (mode >= 2) {
+        __HostTimersSync__();
+        host_stopped = 1;
+        __HostReschedule__();
+    }
+
+    while (dispatched == host_dispatched) {
+        if (host_next_event == HOST_NEVER) {
+            fprintf(stderr, "avrlite-host: asleep with nothing left to wake up at %.6f s\n", Host_seconds());
+            exit(0);
+        }
+        if (host_next_event > host_now)
+            host_now = host_next_event;
+        __HostEvents__();
+        __HostPoll__();
+    }
+    host_stopped = 0;
+}
+
+extern "C" uint8_t __HostRead__(uint8_t address) {
+    uint8_t value = __HostLoad__(address);
+    Host_advance(1);
+    return value;
+}
+
+extern "C" void __HostWrite__(uint8_t address, uint8_t value) {
+    __HostStore__(address, value);
+    Host_advance(1);
+}
+
+extern "C" uint16_t __HostRead16__(uint8_t address) {
+    uint8_t low = __HostLoad__(address);
+    uint8_t high = __HostLoad__(address + 1);
+    Host_advance(2);
+    return low | high << 8;
+}
+
+extern "C" void __HostWrite16__(uint8_t address, uint16_t value) {
+    __HostStore__(address + 1, value >> 8);
+    __HostStore__(address, value & 0xFF);
+    Host_advance(2);
+}
+
+/* ---------------------------------------------------------------- host API */
+
+uint64_t Host_cycles(void) {
+    return host_now;
+}
+
+double Host_seconds(void) {
+    return (double)host_now / F_CPU;
+}
+
+void Host_setTimeLimit(double seconds) {
+    host_limit = seconds > 0 ? (uint64_t)(seconds * F_CPU) : HOST_NEVER;
+    __HostReschedule__();
+}
+
+uint8_t Host_schedule(uint64_t cycle, Host_Event event) {
+    if (host_schedule_count == HOST_SCHEDULE_SIZE)
+        return 0;
+    host_schedule[host_schedule_count].cycle = cycle;
+    host_schedule[host_schedule_count].event = event;
+    host_schedule_count++;
+    __HostReschedule__();
+    return 1;
+}
+
+void Host_onPin(Host_PinHook hook) {
+    host_pin_hook = hook;
+}
+
+void Host_onPwm(Host_PwmHook hook) {
+    host_pwm_hook = hook;
+}
+
+void Host_onSerial(Host_SerialHook hook) {
+    host_serial_hook = hook;
+}
+
+void Host_onSpi(Host_SpiHook hook) {
+    host_spi_hook = hook;
+}
+
+void Host_onAdc(Host_AdcHook hook) {
+    host_adc_hook = hook;
+}
+
+void Host_setPin(uint8_t pin, uint8_t level) {
+    uint8_t bit, port = __HostPinPort__(pin, bit);
+    host_driven[port] |= (1 << bit);
+    if (level)
+        host_input[port] |= (1 << bit);
+    else
+        host_input[port] &= ~(1 << bit);
+    __HostPinsChanged__(port);
+}
+
+void Host_releasePin(uint8_t pin) {
+    uint8_t bit, port = __HostPinPort__(pin, bit);
+    host_driven[port] &= ~(1 << bit);
+    __HostPinsChanged__(port);
+}
+
+void Host_setComparator(uint8_t level) {
+    host_comparator = level ? 1 : 0;
+    __HostComparator__();
+    __HostReschedule__();
+}
+
+void Host_setAnalog(uint8_t pin, uint16_t value) {
+    uint8_t channel = pin >= 14 ? pin - 14 : pin;
+    if (channel < 8)
+        host_analog[channel] = value;
+}
+
+void Host_serialInput(const uint8_t *data, uint16_t length) {
+    if (!host_rx_count)
+        host_rx_ready = host_now + __HostFrameCycles__();
+    while (length-- && host_rx_count < HOST_RX_BUFFER_SIZE) {
+        host_rx[(host_rx_head + host_rx_count) % HOST_RX_BUFFER_SIZE] = *data++;
+        host_rx_count++;
+    }
+    __HostReschedule__();
+}
+
+uint8_t *Host_eeprom(void) {
+    return host_eeprom;
+}
+
+/* ---------------------------------------------------------------- avr-libc */
+
+// Copy of the format with the avr-libc %S (program memory string) turned into %s
+static char *__HostFormat__(const char *format) {
+    char *copy = strdup(format);
+    for (char *p = copy; *p; p++) {
+        if (*p != '%')
+            continue;
+        p++;
+        while (*p && strchr("-+ #0123456789.*hlLqjzt", *p))
+            p++;
+        if (*p == 'S')
+            *p = 's';
+        else if (!*p)
+            break;
+    }
+    return copy;
+}
+
+extern "C" int vsnprintf_P(char *buffer, size_t size, const char *format, va_list args) {
+    char *copy = __HostFormat__(format);
+    int length = vsnprintf(buffer, size, copy, args);
+    free(copy);
+    return length;
+}
+
+extern "C" int snprintf_P(char *buffer, size_t size, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf_P(buffer, size, format, args);
+    va_end(args);
+    return length;
+}
+
+extern "C" int sprintf_P(char *buffer, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf_P(buffer, INT_MAX, format, args);
+    va_end(args);
+    return length;
+}
+
+extern "C" int printf_P(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    char *copy = __HostFormat__(format);
+    int length = vprintf(copy, args);
+    free(copy);
+    va_end(args);
+    return length;
+}
+
+/* ---------------------------------------------------------------- startup */
+
+static void __HostSaveEeprom__() {
+    const char *path = getenv("AVRLITE_HOST_EEPROM");
+    FILE *file = path ? fopen(path, "wb") : NULL;
+    if (!file)
+        return;
+    fwrite(host_eeprom, 1, sizeof(host_eeprom), file);
+    fclose(file);
+}
+
+static void __HostExit__() {
+    fflush(stdout);
+    __HostSaveEeprom__();
+    if (host_trace)
+        fprintf(stderr, "avrlite-host: stopped at %.6f s (%llu cycles)\n", Host_seconds(), (unsigned long long)host_now);
+}
+
+// Reset state, runs before the firmware's own constructors
+static void __attribute__((constructor(101))) __HostReset__() {
+    memset(host_eeprom, 0xFF, sizeof(host_eeprom));
+    const char *path = getenv("AVRLITE_HOST_EEPROM");
+    FILE *file = path ? fopen(path, "rb") : NULL;
+    if (file) {
+        if (fread(host_eeprom, 1, sizeof(host_eeprom), file) != sizeof(host_eeprom))
+            fprintf(stderr, "avrlite-host: %s is shorter than the EEPROM\n", path);
+        fclose(file);
+    }
+
+    const char *seconds = getenv("AVRLITE_HOST_SECONDS");
+    if (seconds)
+        Host_setTimeLimit(atof(seconds));
+    host_trace = getenv("AVRLITE_HOST_TRACE") != NULL;
+
+    IO(MCUSR) = (1 << PORF);
+    IO(UCSR0A) = (1 << UDRE0);
+    IO(UCSR0C) = (1 << UCSZ01) | (1 << UCSZ00);
+    __HostReschedule__();
+    atexit(__HostExit__);
+}
@@ -0,0 +1,89 @@
+/**
+ * @file AVRHost.h
+ * @brief Host-native backend: runs AVRLite firmware on a PC against an emulated ATmega328P
+ *
+ * @details
+ * The headers in host/avr and host/util replace avr-libc. Registers become objects backed by an
+ * emulated register file, and a virtual clock advances one cycle per register access plus any
+ * _delay_us/_delay_ms. Timers 0-2, USART0, ADC, SPI master, EEPROM, watchdog, pin change and
+ * external interrupts, input capture and the analog comparator output are emulated. Their
+ * interrupts run in hardware priority order whenever the I bit is set. sleep_cpu() jumps straight
+ * to the next event, so an idle firmware covers hours of device time in seconds.
+ *
+ * Pins use the AVRLite numbering: 0-7 = PD0-PD7, 8-13 = PB0-PB5, 14-19 = PC0-PC5 (A0-A5).
+ *
+ * Environment:
+ * - AVRLITE_HOST_SECONDS: stop after this much device time (default: run until the firmware
+ *   sleeps with interrupts disabled or nothing is left to wake it)
+ * - AVRLITE_HOST_TRACE: print pin and PWM changes to stderr
+ * - AVRLITE_HOST_EEPROM: file holding the EEPROM contents, loaded at start and saved at exit
+ *
+ * Limits: instructions between register accesses take no time, so timing is approximate.
+ * Phase-correct PWM counts like fast PWM, TWI is not emulated, serial input never overruns.
+ */
+
+#ifndef AVRHost_h
+#define AVRHost_h
+
+#include <stdint.h>
+
+// Pin level callback, also called for inputs driven with Host_setPin
+typedef void (*Host_PinHook)(uint64_t cycle, uint8_t pin, uint8_t level);
+// PWM output callback: compare value and counter top, top is 0 when the output is disconnected
+typedef void (*Host_PwmHook)(uint64_t cycle, uint8_t pin, uint16_t value, uint16_t top);
+// Byte sent by USART0, the default writes it to stdout
+typedef void (*Host_SerialHook)(uint64_t cycle, uint8_t data);
+// SPI master transfer, returns the byte clocked in from the device (default 0xFF)
+typedef uint8_t (*Host_SpiHook)(uint64_t cycle, uint8_t data);
+// ADC conversion result for a channel (0-15), replaces the values from Host_setAnalog
+typedef uint16_t (*Host_AdcHook)(uint64_t cycle, uint8_t channel);
+// Scheduled host event
+typedef void (*Host_Event)(void);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Virtual clock in CPU cycles since reset
+uint64_t Host_cycles(void);
+
+// Virtual clock in seconds since reset
+double Host_seconds(void);
+
+// Advance the virtual clock, due interrupts run on the way
+void Host_advance(uint64_t cycles);
+
+// Stop the run (exit code 0) once the virtual clock reaches `seconds`
+void Host_setTimeLimit(double seconds);
+
+// Call `event` when the virtual clock reaches `cycle`, returns 1 on success or 0 if the queue is full
+uint8_t Host_schedule(uint64_t cycle, Host_Event event);
+
+// Install callbacks, NULL restores the default
+void Host_onPin(Host_PinHook hook);
+void Host_onPwm(Host_PwmHook hook);
+void Host_onSerial(Host_SerialHook hook);
+void Host_onSpi(Host_SpiHook hook);
+void Host_onAdc(Host_AdcHook hook);
+
+// Drive an input pin from outside, pin change, external interrupts and input capture follow
+void Host_setPin(uint8_t pin, uint8_t level);
+
+// Stop driving an input pin, it reads its pull-up (or 0 when floating) again
+void Host_releasePin(uint8_t pin);
+
+// Set the 10-bit value converted on an analog pin (A0-A5) or ADC channel (0-7)
+void Host_setAnalog(uint8_t pin, uint16_t value);
+
+// Set the analog comparator output (AIN0 above the negative input), the comparison itself is not modelled
+void Host_setComparator(uint8_t level);
+
+// Queue bytes for USART0 to receive, one per frame time at the configured baud rate
+void Host_serialInput(const uint8_t *data, uint16_t length);
+
+// The emulated EEPROM contents (E2END + 1 bytes)
+uint8_t *Host_eeprom(void);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,14 @@
+/**
+ * @file cpufunc.h
+ * @brief CPU helpers for the host build (see AVRHost.h)
+ */
+
+#ifndef _AVR_CPUFUNC_H_
+#define _AVR_CPUFUNC_H_
+
+#include "AVRHost.h"
+
+#define _NOP() Host_advance(1)
+#define _MemoryBarrier() __asm__ __volatile__("" ::: "memory")
+
+#endif
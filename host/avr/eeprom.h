@@ -0,0 +1,56 @@
+/**
+ * @file eeprom.h
+ * @brief avr-libc EEPROM functions for the host build (see AVRHost.h)
+ *
+ * @details
+ * Implemented on the EECR/EEAR/EEDR registers, so writes take the emulated 3.4 ms.
+ */
+
+#ifndef _AVR_EEPROM_H_
+#define _AVR_EEPROM_H_
+
+#include <avr/io.h>
+#include <stddef.h>
+
+#define EEMEM
+
+static inline void eeprom_busy_wait(void) {
+    while (EECR & (1 << EEPE));
+}
+
+static inline uint8_t eeprom_read_byte(const uint8_t *address) {
+    eeprom_busy_wait();
+    EEAR = (uint16_t)(uintptr_t)address;
+    EECR |= (1 << EERE);
+    return EEDR;
+}
+
+static inline void eeprom_write_byte(uint8_t *address, uint8_t value) {
+    eeprom_busy_wait();
+    EEAR = (uint16_t)(uintptr_t)address;
+    EEDR = value;
+    EECR = (1 << EEMPE);
+    EECR |= (1 << EEPE);
+}
+
+static inline void eeprom_update_byte(uint8_t *address, uint8_t value) {
+    if (eeprom_read_byte(address) != value)
+        eeprom_write_byte(address, value);
+}
+
+static inline void eeprom_read_block(void *destination, const void *source, size_t length) {
+    for (size_t i = 0; i < length; i++)
+        ((uint8_t *)destination)[i] = eeprom_read_byte((const uint8_t *)source + i);
+}
+
+static inline void eeprom_write_block(const void *source, void *destination, size_t length) {
+    for (size_t i = 0; i < length; i++)
+        eeprom_write_byte((uint8_t *)destination + i, ((const uint8_t *)source)[i]);
+}
+
+static inline void eeprom_update_block(const void *source, void *destination, size_t length) {
+    for (size_t i = 0; i < length; i++)
+        eeprom_update_byte((uint8_t *)destination + i, ((const uint8_t *)source)[i]);
+}
+
+#endif
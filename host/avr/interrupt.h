@@ -0,0 +1,67 @@
+/**
+ * @file interrupt.h
+ * @brief Interrupt vectors and ISR() for the host build (see AVRHost.h)
+ *
+ * @details
+ * Vectors keep the avr-libc symbol names (__vector_N), the emulator calls them in hardware
+ * priority order while the I bit in SREG is set.
+ */
+
+#ifndef _AVR_INTERRUPT_H_
+#define _AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+#define INT0_vect         __vector_1
+#define INT1_vect         __vector_2
+#define PCINT0_vect       __vector_3
+#define PCINT1_vect       __vector_4
+#define PCINT2_vect       __vector_5
+#define WDT_vect          __vector_6
+#define TIMER2_COMPA_vect __vector_7
+#define TIMER2_COMPB_vect __vector_8
+#define TIMER2_OVF_vect   __vector_9
+#define TIMER1_CAPT_vect  __vector_10
+#define TIMER1_COMPA_vect __vector_11
+#define TIMER1_COMPB_vect __vector_12
+#define TIMER1_OVF_vect   __vector_13
+#define TIMER0_COMPA_vect __vector_14
+#define TIMER0_COMPB_vect __vector_15
+#define TIMER0_OVF_vect   __vector_16
+#define SPI_STC_vect      __vector_17
+#define USART_RX_vect     __vector_18
+#define USART_UDRE_vect   __vector_19
+#define USART_TX_vect     __vector_20
+#define ADC_vect          __vector_21
+#define EE_READY_vect     __vector_22
+#define ANALOG_COMP_vect  __vector_23
+#define TWI_vect          __vector_24
+#define SPM_READY_vect    __vector_25
+#define _VECTORS_SIZE     104
+
+#define __HOST_STRING__(x) #x
+#define __HOST_VECTOR_NAME__(vector) __HOST_STRING__(vector)
+
+#define ISR(vector, ...) \
+    extern "C" void vector(void) __VA_ARGS__; \
+    extern "C" void vector(void)
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+#define ISR_ALIASOF(vector) __attribute__((alias(__HOST_VECTOR_NAME__(vector))))
+#define EMPTY_INTERRUPT(vector) extern "C" void vector(void) {}
+#define reti() return
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Set the I bit, pending interrupts run after the next instruction like on the device
+void __HostSei__(void);
+#ifdef __cplusplus
+}
+#endif
+
+static inline void sei(void) { __HostSei__(); }
+static inline void cli(void) { SREG &= ~(1 << SREG_I); }
+
+#endif
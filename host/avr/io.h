@@ -0,0 +1,573 @@
+/**
+ * @file io.h
+ * @brief ATmega328P register file for the host build (see AVRHost.h)
+ *
+ * @details
+ * Every register is an object at its real data-space address. Reads and writes go through
+ * the emulator, which advances the virtual clock by one cycle per access and runs pending
+ * interrupts, so firmware written against <avr/io.h> compiles and runs unchanged.
+ */
+
+#ifndef _AVR_IO_H_
+#define _AVR_IO_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Emulator entry points, implemented in AVRHost.cpp
+uint8_t __HostRead__(uint8_t address);
+void __HostWrite__(uint8_t address, uint8_t value);
+uint16_t __HostRead16__(uint8_t address);
+void __HostWrite16__(uint8_t address, uint16_t value);
+#ifdef __cplusplus
+}
+#endif
+
+// 8-bit I/O register, behaves like `volatile uint8_t` in expressions (assignments truncate)
+class __HostRegister8__ {
+public:
+    constexpr explicit __HostRegister8__(uint8_t address) : address(address) {}
+    operator uint8_t() const { return __HostRead__(address); }
+    const __HostRegister8__ &operator=(int value) const { __HostWrite__(address, (uint8_t)value); return *this; }
+    const __HostRegister8__ &operator|=(int value) const { return *this = (uint8_t)(*this | value); }
+    const __HostRegister8__ &operator&=(int value) const { return *this = (uint8_t)(*this & value); }
+    const __HostRegister8__ &operator^=(int value) const { return *this = (uint8_t)(*this ^ value); }
+    const __HostRegister8__ &operator+=(int value) const { return *this = (uint8_t)(*this + value); }
+    const __HostRegister8__ &operator-=(int value) const { return *this = (uint8_t)(*this - value); }
+    const uint8_t address;
+};
+
+// 16-bit register pair, accessed atomically like the TEMP-latched hardware sequence
+class __HostRegister16__ {
+public:
+    constexpr explicit __HostRegister16__(uint8_t address) : address(address) {}
+    operator uint16_t() const { return __HostRead16__(address); }
+    const __HostRegister16__ &operator=(long value) const { __HostWrite16__(address, (uint16_t)value); return *this; }
+    const __HostRegister16__ &operator|=(long value) const { return *this = (uint16_t)(*this | value); }
+    const __HostRegister16__ &operator&=(long value) const { return *this = (uint16_t)(*this & value); }
+    const __HostRegister16__ &operator^=(long value) const { return *this = (uint16_t)(*this ^ value); }
+    const __HostRegister16__ &operator+=(long value) const { return *this = (uint16_t)(*this + value); }
+    const __HostRegister16__ &operator-=(long value) const { return *this = (uint16_t)(*this - value); }
+    const uint8_t address;
+};
+
+#define _BV(bit) (1 << (bit))
+#define _SFR_MEM_ADDR(reg) ((reg).address)
+#define _SFR_MEM8(address) (__HostRegister8__(address))
+#define _SFR_IO_ADDR(reg) ((reg).address - 0x20)
+#define bit_is_set(reg, bit) ((reg) & _BV(bit))
+#define bit_is_clear(reg, bit) (!((reg) & _BV(bit)))
+#define loop_until_bit_is_set(reg, bit) do { } while (bit_is_clear(reg, bit))
+#define loop_until_bit_is_clear(reg, bit) do { } while (bit_is_set(reg, bit))
+
+// Memory sizes
+#define RAMSTART 0x100
+#define RAMEND 0x8FF
+#define XRAMEND RAMEND
+#define E2END 0x3FF
+#define E2PAGESIZE 4
+#define FLASHEND 0x7FFF
+#define SPM_PAGESIZE 128
+
+// Port B
+static constexpr __HostRegister8__ PINB(0x23);
+static constexpr __HostRegister8__ DDRB(0x24);
+static constexpr __HostRegister8__ PORTB(0x25);
+// Port C
+static constexpr __HostRegister8__ PINC(0x26);
+static constexpr __HostRegister8__ DDRC(0x27);
+static constexpr __HostRegister8__ PORTC(0x28);
+// Port D
+static constexpr __HostRegister8__ PIND(0x29);
+static constexpr __HostRegister8__ DDRD(0x2A);
+static constexpr __HostRegister8__ PORTD(0x2B);
+
+// Interrupt flags and masks
+static constexpr __HostRegister8__ TIFR0(0x35);
+static constexpr __HostRegister8__ TIFR1(0x36);
+static constexpr __HostRegister8__ TIFR2(0x37);
+static constexpr __HostRegister8__ PCIFR(0x3B);
+static constexpr __HostRegister8__ EIFR(0x3C);
+static constexpr __HostRegister8__ EIMSK(0x3D);
+static constexpr __HostRegister8__ PCICR(0x68);
+static constexpr __HostRegister8__ EICRA(0x69);
+static constexpr __HostRegister8__ PCMSK0(0x6B);
+static constexpr __HostRegister8__ PCMSK1(0x6C);
+static constexpr __HostRegister8__ PCMSK2(0x6D);
+static constexpr __HostRegister8__ TIMSK0(0x6E);
+static constexpr __HostRegister8__ TIMSK1(0x6F);
+static constexpr __HostRegister8__ TIMSK2(0x70);
+
+// General purpose I/O registers
+static constexpr __HostRegister8__ GPIOR0(0x3E);
+static constexpr __HostRegister8__ GPIOR1(0x4A);
+static constexpr __HostRegister8__ GPIOR2(0x4B);
+
+// EEPROM
+static constexpr __HostRegister8__ EECR(0x3F);
+static constexpr __HostRegister8__ EEDR(0x40);
+static constexpr __HostRegister8__ EEARL(0x41);
+static constexpr __HostRegister8__ EEARH(0x42);
+static constexpr __HostRegister16__ EEAR(0x41);
+
+// Timer/Counter0
+static constexpr __HostRegister8__ GTCCR(0x43);
+static constexpr __HostRegister8__ TCCR0A(0x44);
+static constexpr __HostRegister8__ TCCR0B(0x45);
+static constexpr __HostRegister8__ TCNT0(0x46);
+static constexpr __HostRegister8__ OCR0A(0x47);
+static constexpr __HostRegister8__ OCR0B(0x48);
+
+// SPI
+static constexpr __HostRegister8__ SPCR(0x4C);
+static constexpr __HostRegister8__ SPSR(0x4D);
+static constexpr __HostRegister8__ SPDR(0x4E);
+
+// Analog comparator, sleep and MCU control
+static constexpr __HostRegister8__ ACSR(0x50);
+static constexpr __HostRegister8__ SMCR(0x53);
+static constexpr __HostRegister8__ MCUSR(0x54);
+static constexpr __HostRegister8__ MCUCR(0x55);
+static constexpr __HostRegister8__ SPMCSR(0x57);
+static constexpr __HostRegister8__ SPL(0x5D);
+static constexpr __HostRegister8__ SPH(0x5E);
+static constexpr __HostRegister16__ SP(0x5D);
+static constexpr __HostRegister8__ SREG(0x5F);
+
+// Watchdog, clock and power
+static constexpr __HostRegister8__ WDTCSR(0x60);
+static constexpr __HostRegister8__ CLKPR(0x61);
+static constexpr __HostRegister8__ PRR(0x64);
+static constexpr __HostRegister8__ OSCCAL(0x66);
+
+// ADC
+static constexpr __HostRegister8__ ADCL(0x78);
+static constexpr __HostRegister8__ ADCH(0x79);
+static constexpr __HostRegister16__ ADC(0x78);
+static constexpr __HostRegister16__ ADCW(0x78);
+static constexpr __HostRegister8__ ADCSRA(0x7A);
+static constexpr __HostRegister8__ ADCSRB(0x7B);
+static constexpr __HostRegister8__ ADMUX(0x7C);
+static constexpr __HostRegister8__ DIDR0(0x7E);
+static constexpr __HostRegister8__ DIDR1(0x7F);
+
+// Timer/Counter1
+static constexpr __HostRegister8__ TCCR1A(0x80);
+static constexpr __HostRegister8__ TCCR1B(0x81);
+static constexpr __HostRegister8__ TCCR1C(0x82);
+static constexpr __HostRegister8__ TCNT1L(0x84);
+static constexpr __HostRegister8__ TCNT1H(0x85);
+static constexpr __HostRegister16__ TCNT1(0x84);
+static constexpr __HostRegister8__ ICR1L(0x86);
+static constexpr __HostRegister8__ ICR1H(0x87);
+static constexpr __HostRegister16__ ICR1(0x86);
+static constexpr __HostRegister8__ OCR1AL(0x88);
+static constexpr __HostRegister8__ OCR1AH(0x89);
+static constexpr __HostRegister16__ OCR1A(0x88);
+static constexpr __HostRegister8__ OCR1BL(0x8A);
+static constexpr __HostRegister8__ OCR1BH(0x8B);
+static constexpr __HostRegister16__ OCR1B(0x8A);
+
+// Timer/Counter2
+static constexpr __HostRegister8__ TCCR2A(0xB0);
+static constexpr __HostRegister8__ TCCR2B(0xB1);
+static constexpr __HostRegister8__ TCNT2(0xB2);
+static constexpr __HostRegister8__ OCR2A(0xB3);
+static constexpr __HostRegister8__ OCR2B(0xB4);
+static constexpr __HostRegister8__ ASSR(0xB6);
+
+// TWI
+static constexpr __HostRegister8__ TWBR(0xB8);
+static constexpr __HostRegister8__ TWSR(0xB9);
+static constexpr __HostRegister8__ TWAR(0xBA);
+static constexpr __HostRegister8__ TWDR(0xBB);
+static constexpr __HostRegister8__ TWCR(0xBC);
+static constexpr __HostRegister8__ TWAMR(0xBD);
+
+// USART0
+static constexpr __HostRegister8__ UCSR0A(0xC0);
+static constexpr __HostRegister8__ UCSR0B(0xC1);
+static constexpr __HostRegister8__ UCSR0C(0xC2);
+static constexpr __HostRegister8__ UBRR0L(0xC4);
+static constexpr __HostRegister8__ UBRR0H(0xC5);
+static constexpr __HostRegister16__ UBRR0(0xC4);
+static constexpr __HostRegister8__ UDR0(0xC6);
+
+// Port bits
+#define PINB0 0
+#define PINB1 1
+#define PINB2 2
+#define PINB3 3
+#define PINB4 4
+#define PINB5 5
+#define PINB6 6
+#define PINB7 7
+#define DDB0 0
+#define DDB1 1
+#define DDB2 2
+#define DDB3 3
+#define DDB4 4
+#define DDB5 5
+#define DDB6 6
+#define DDB7 7
+#define PORTB0 0
+#define PORTB1 1
+#define PORTB2 2
+#define PORTB3 3
+#define PORTB4 4
+#define PORTB5 5
+#define PORTB6 6
+#define PORTB7 7
+#define PINC0 0
+#define PINC1 1
+#define PINC2 2
+#define PINC3 3
+#define PINC4 4
+#define PINC5 5
+#define PINC6 6
+#define DDC0 0
+#define DDC1 1
+#define DDC2 2
+#define DDC3 3
+#define DDC4 4
+#define DDC5 5
+#define DDC6 6
+#define PORTC0 0
+#define PORTC1 1
+#define PORTC2 2
+#define PORTC3 3
+#define PORTC4 4
+#define PORTC5 5
+#define PORTC6 6
+#define PIND0 0
+#define PIND1 1
+#define PIND2 2
+#define PIND3 3
+#define PIND4 4
+#define PIND5 5
+#define PIND6 6
+#define PIND7 7
+#define DDD0 0
+#define DDD1 1
+#define DDD2 2
+#define DDD3 3
+#define DDD4 4
+#define DDD5 5
+#define DDD6 6
+#define DDD7 7
+#define PORTD0 0
+#define PORTD1 1
+#define PORTD2 2
+#define PORTD3 3
+#define PORTD4 4
+#define PORTD5 5
+#define PORTD6 6
+#define PORTD7 7
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+// TIFR0, TIMSK0
+#define TOV0 0
+#define OCF0A 1
+#define OCF0B 2
+#define TOIE0 0
+#define OCIE0A 1
+#define OCIE0B 2
+// TIFR1, TIMSK1
+#define TOV1 0
+#define OCF1A 1
+#define OCF1B 2
+#define ICF1 5
+#define TOIE1 0
+#define OCIE1A 1
+#define OCIE1B 2
+#define ICIE1 5
+// TIFR2, TIMSK2
+#define TOV2 0
+#define OCF2A 1
+#define OCF2B 2
+#define TOIE2 0
+#define OCIE2A 1
+#define OCIE2B 2
+
+// PCIFR, PCICR, EIFR, EIMSK, EICRA
+#define PCIF0 0
+#define PCIF1 1
+#define PCIF2 2
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+#define INTF0 0
+#define INTF1 1
+#define INT0 0
+#define INT1 1
+#define ISC00 0
+#define ISC01 1
+#define ISC10 2
+#define ISC11 3
+
+// PCMSK0, PCMSK1, PCMSK2
+#define PCINT0 0
+#define PCINT1 1
+#define PCINT2 2
+#define PCINT3 3
+#define PCINT4 4
+#define PCINT5 5
+#define PCINT6 6
+#define PCINT7 7
+#define PCINT8 0
+#define PCINT9 1
+#define PCINT10 2
+#define PCINT11 3
+#define PCINT12 4
+#define PCINT13 5
+#define PCINT14 6
+#define PCINT16 0
+#define PCINT17 1
+#define PCINT18 2
+#define PCINT19 3
+#define PCINT20 4
+#define PCINT21 5
+#define PCINT22 6
+#define PCINT23 7
+
+// EECR
+#define EERE 0
+#define EEPE 1
+#define EEMPE 2
+#define EERIE 3
+#define EEPM0 4
+#define EEPM1 5
+
+// GTCCR
+#define PSRSYNC 0
+#define PSRASY 1
+#define TSM 7
+
+// TCCR0A, TCCR0B
+#define WGM00 0
+#define WGM01 1
+#define COM0B0 4
+#define COM0B1 5
+#define COM0A0 6
+#define COM0A1 7
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define WGM02 3
+#define FOC0B 6
+#define FOC0A 7
+
+// SPCR, SPSR
+#define SPR0 0
+#define SPR1 1
+#define CPHA 2
+#define CPOL 3
+#define MSTR 4
+#define DORD 5
+#define SPE 6
+#define SPIE 7
+#define SPI2X 0
+#define WCOL 6
+#define SPIF 7
+
+// ACSR
+#define ACIS0 0
+#define ACIS1 1
+#define ACIC 2
+#define ACIE 3
+#define ACI 4
+#define ACO 5
+#define ACBG 6
+#define ACD 7
+
+// SMCR, MCUSR, MCUCR, SPMCSR
+#define SE 0
+#define SM0 1
+#define SM1 2
+#define SM2 3
+#define PORF 0
+#define EXTRF 1
+#define BORF 2
+#define WDRF 3
+#define IVCE 0
+#define IVSEL 1
+#define PUD 4
+#define BODSE 5
+#define BODS 6
+#define SPMEN 0
+#define SELFPRGEN 0
+#define PGERS 1
+#define PGWRT 2
+#define BLBSET 3
+#define RWWSRE 4
+#define SIGRD 5
+#define RWWSB 6
+#define SPMIE 7
+
+// SREG
+#define SREG_C 0
+#define SREG_Z 1
+#define SREG_N 2
+#define SREG_V 3
+#define SREG_S 4
+#define SREG_H 5
+#define SREG_T 6
+#define SREG_I 7
+
+// WDTCSR, CLKPR, PRR
+#define WDP0 0
+#define WDP1 1
+#define WDP2 2
+#define WDE 3
+#define WDCE 4
+#define WDP3 5
+#define WDIE 6
+#define WDIF 7
+#define CLKPS0 0
+#define CLKPS1 1
+#define CLKPS2 2
+#define CLKPS3 3
+#define CLKPCE 7
+#define PRADC 0
+#define PRUSART0 1
+#define PRSPI 2
+#define PRTIM1 3
+#define PRTIM0 5
+#define PRTIM2 6
+#define PRTWI 7
+
+// ADCSRA, ADCSRB, ADMUX, DIDR0, DIDR1
+#define ADPS0 0
+#define ADPS1 1
+#define ADPS2 2
+#define ADIE 3
+#define ADIF 4
+#define ADATE 5
+#define ADSC 6
+#define ADEN 7
+#define ADTS0 0
+#define ADTS1 1
+#define ADTS2 2
+#define ACME 6
+#define MUX0 0
+#define MUX1 1
+#define MUX2 2
+#define MUX3 3
+#define ADLAR 5
+#define REFS0 6
+#define REFS1 7
+#define ADC0D 0
+#define ADC1D 1
+#define ADC2D 2
+#define ADC3D 3
+#define ADC4D 4
+#define ADC5D 5
+#define AIN0D 0
+#define AIN1D 1
+
+// TCCR1A, TCCR1B, TCCR1C
+#define WGM10 0
+#define WGM11 1
+#define COM1B0 4
+#define COM1B1 5
+#define COM1A0 6
+#define COM1A1 7
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define WGM12 3
+#define WGM13 4
+#define ICES1 6
+#define ICNC1 7
+#define FOC1B 6
+#define FOC1A 7
+
+// TCCR2A, TCCR2B, ASSR
+#define WGM20 0
+#define WGM21 1
+#define COM2B0 4
+#define COM2B1 5
+#define COM2A0 6
+#define COM2A1 7
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define WGM22 3
+#define FOC2B 6
+#define FOC2A 7
+#define TCR2BUB 0
+#define TCR2AUB 1
+#define OCR2BUB 2
+#define OCR2AUB 3
+#define TCN2UB 4
+#define AS2 5
+#define EXCLK 6
+
+// TWSR, TWAR, TWCR
+#define TWPS0 0
+#define TWPS1 1
+#define TWS3 3
+#define TWS4 4
+#define TWS5 5
+#define TWS6 6
+#define TWS7 7
+#define TWGCE 0
+#define TWIE 0
+#define TWEN 2
+#define TWWC 3
+#define TWSTO 4
+#define TWSTA 5
+#define TWEA 6
+#define TWINT 7
+
+// UCSR0A, UCSR0B, UCSR0C
+#define MPCM0 0
+#define U2X0 1
+#define UPE0 2
+#define DOR0 3
+#define FE0 4
+#define UDRE0 5
+#define TXC0 6
+#define RXC0 7
+#define TXB80 0
+#define RXB80 1
+#define UCSZ02 2
+#define TXEN0 3
+#define RXEN0 4
+#define UDRIE0 5
+#define TXCIE0 6
+#define RXCIE0 7
+#define UCPOL0 0
+#define UCSZ00 1
+#define UCSZ01 2
+#define USBS0 3
+#define UPM00 4
+#define UPM01 5
+#define UMSEL00 6
+#define UMSEL01 7
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * @file pgmspace.h
+ * @brief Program memory access for the host build (see AVRHost.h)
+ *
+ * @details
+ * Flash and RAM share one address space on the host, PROGMEM data is read directly.
+ */
+
+#ifndef __PGMSPACE_H_
+#define __PGMSPACE_H_
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PGM_VOID_P const void *
+#define PSTR(s) (s)
+
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#define pgm_read_dword(address) (*(const uint32_t *)(address))
+#define pgm_read_float(address) (*(const float *)(address))
+#define pgm_read_ptr(address) (*(void *const *)(address))
+#define pgm_read_byte_near pgm_read_byte
+#define pgm_read_word_near pgm_read_word
+#define pgm_read_dword_near pgm_read_dword
+
+#define memcmp_P memcmp
+#define memcpy_P memcpy
+#define strcat_P strcat
+#define strcmp_P strcmp
+#define strcpy_P strcpy
+#define strlen_P strlen
+#define strncmp_P strncmp
+#define strncpy_P strncpy
+#define strcasecmp_P strcasecmp
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// vsnprintf with the avr-libc %S conversion (string in program memory)
+int vsnprintf_P(char *buffer, size_t size, const char *format, va_list args);
+int snprintf_P(char *buffer, size_t size, const char *format, ...);
+int sprintf_P(char *buffer, const char *format, ...);
+int printf_P(const char *format, ...);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
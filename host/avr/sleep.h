@@ -0,0 +1,44 @@
+/**
+ * @file sleep.h
+ * @brief Sleep modes for the host build (see AVRHost.h)
+ *
+ * @details
+ * sleep_cpu() advances the virtual clock to the next interrupt. In the power-down modes
+ * the timers stop, only the watchdog, pin changes and scheduled host events wake the CPU.
+ */
+
+#ifndef _AVR_SLEEP_H_
+#define _AVR_SLEEP_H_
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE        (0)
+#define SLEEP_MODE_ADC         (1 << SM0)
+#define SLEEP_MODE_PWR_DOWN    (1 << SM1)
+#define SLEEP_MODE_PWR_SAVE    ((1 << SM0) | (1 << SM1))
+#define SLEEP_MODE_STANDBY     ((1 << SM1) | (1 << SM2))
+#define SLEEP_MODE_EXT_STANDBY ((1 << SM0) | (1 << SM1) | (1 << SM2))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Sleep until an interrupt has run, implemented in AVRHost.cpp
+void __HostSleep__(void);
+#ifdef __cplusplus
+}
+#endif
+
+static inline void set_sleep_mode(uint8_t mode) {
+    SMCR = (SMCR & ~((1 << SM0) | (1 << SM1) | (1 << SM2))) | mode;
+}
+static inline void sleep_enable(void) { SMCR |= (1 << SE); }
+static inline void sleep_disable(void) { SMCR &= ~(1 << SE); }
+static inline void sleep_cpu(void) { __HostSleep__(); }
+static inline void sleep_bod_disable(void) {}
+static inline void sleep_mode(void) {
+    sleep_enable();
+    sleep_cpu();
+    sleep_disable();
+}
+
+#endif
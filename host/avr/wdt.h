@@ -0,0 +1,44 @@
+/**
+ * @file wdt.h
+ * @brief Watchdog timer for the host build (see AVRHost.h)
+ *
+ * @details
+ * A watchdog reset ends the run with exit code 2.
+ */
+
+#ifndef _AVR_WDT_H_
+#define _AVR_WDT_H_
+
+#include <avr/io.h>
+
+#define WDTO_15MS  0
+#define WDTO_30MS  1
+#define WDTO_60MS  2
+#define WDTO_120MS 3
+#define WDTO_250MS 4
+#define WDTO_500MS 5
+#define WDTO_1S    6
+#define WDTO_2S    7
+#define WDTO_4S    8
+#define WDTO_8S    9
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Restart the watchdog period, implemented in AVRHost.cpp
+void __HostWatchdogReset__(void);
+#ifdef __cplusplus
+}
+#endif
+
+static inline void wdt_reset(void) { __HostWatchdogReset__(); }
+static inline void wdt_enable(uint8_t period) {
+    WDTCSR = (1 << WDCE) | (1 << WDE);
+    WDTCSR = (1 << WDE) | (period & 0x07) | ((period & 0x08) ? (1 << WDP3) : 0);
+}
+static inline void wdt_disable(void) {
+    WDTCSR = (1 << WDCE) | (1 << WDE);
+    WDTCSR = 0;
+}
+
+#endif
@@ -0,0 +1,35 @@
+/**
+ * @file atomic.h
+ * @brief ATOMIC_BLOCK for the host build (see AVRHost.h)
+ */
+
+#ifndef _UTIL_ATOMIC_H_
+#define _UTIL_ATOMIC_H_
+
+#include <avr/interrupt.h>
+
+static inline uint8_t __HostAtomicBegin__(void) {
+    uint8_t oldSREG = SREG;
+    cli();
+    return oldSREG;
+}
+
+static inline void __HostAtomicRestore__(const uint8_t *oldSREG) { SREG = *oldSREG; }
+static inline void __HostAtomicForceOn__(const uint8_t *) { sei(); }
+static inline uint8_t __HostNonAtomicBegin__(void) {
+    uint8_t oldSREG = SREG;
+    sei();
+    return oldSREG;
+}
+
+static inline void __HostNonAtomicForceOff__(const uint8_t *) { cli(); }
+
+#define ATOMIC_RESTORESTATE uint8_t sreg_save __attribute__((__cleanup__(__HostAtomicRestore__))) = __HostAtomicBegin__()
+#define ATOMIC_FORCEON uint8_t sreg_save __attribute__((__cleanup__(__HostAtomicForceOn__))) = __HostAtomicBegin__()
+#define NONATOMIC_RESTORESTATE uint8_t sreg_save __attribute__((__cleanup__(__HostAtomicRestore__))) = __HostNonAtomicBegin__()
+#define NONATOMIC_FORCEOFF uint8_t sreg_save __attribute__((__cleanup__(__HostNonAtomicForceOff__))) = __HostNonAtomicBegin__()
+
+#define ATOMIC_BLOCK(type) for (type, __ToDo = 1; __ToDo; __ToDo = 0)
+#define NONATOMIC_BLOCK(type) for (type, __ToDo = 1; __ToDo; __ToDo = 0)
+
+#endif
@@ -0,0 +1,34 @@
+/**
+ * @file delay.h
+ * @brief Busy-wait delays for the host build (see AVRHost.h)
+ *
+ * @details
+ * The delay advances the virtual clock, interrupts that fall inside it run on time.
+ */
+
+#ifndef _UTIL_DELAY_H_
+#define _UTIL_DELAY_H_
+
+#include "AVRHost.h"
+
+#ifndef F_CPU
+#error "F_CPU must be defined for <util/delay.h>"
+#endif
+
+static inline void _delay_us(double us) {
+    Host_advance((uint64_t)(us * (F_CPU / 1e6)));
+}
+
+static inline void _delay_ms(double ms) {
+    Host_advance((uint64_t)(ms * (F_CPU / 1e3)));
+}
+
+static inline void _delay_loop_1(uint8_t count) {
+    Host_advance(count ? 3ULL * count : 768);
+}
+
+static inline void _delay_loop_2(uint16_t count) {
+    Host_advance(count ? 4ULL * count : 262144);
+}
+
+#endif
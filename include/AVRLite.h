@@ -5,8 +5,10 @@
 #include <stdlib.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#include <avr/pgmspace.h>
 #include <util/delay.h>
-#include <math.h>
+
+#include "AVRLiteConfig.h"
 
 // Definitions for HIGH and LOW states
 #define LOW          0x0
@@ -21,6 +23,22 @@
 #define ANALOGWRITE  0xA1
 #define DIGITALREAD  0xD
 
+// Maximum accepted baud rate error, in hundredths of a percent (2.5%)
+#ifndef SERIAL_BAUD_TOLERANCE
+#define SERIAL_BAUD_TOLERANCE 250
+#endif
+
+// Size of the interrupt-driven Serial transmit buffer (power of two, at most 128)
+#ifndef SERIAL_TX_BUFFER_SIZE
+#define SERIAL_TX_BUFFER_SIZE 64
+#endif
+
+// Flag bit of a baud setting selecting double-speed mode (U2X0)
+#define SERIAL_U2X_FLAG 0x8000
+
+// Timer1 runs free at F_CPU, uptimeMs ticks every TIMER1_TICKS_PER_MS counts
+#define TIMER1_TICKS_PER_MS (F_CPU / 1000)
+
 // Definitions for analog pins A0 to A5
 #define A0 0xE
 #define A1 0xF
@@ -54,13 +72,16 @@
 #ifdef __cplusplus
 extern "C" {
 #endif
-// Return the number of milliseconds since the program started
+// Start the timekeeping timers (Timer0, Timer1), done by the time functions on first use
+void __TimeBegin__();
+
+// Return the number of milliseconds since timekeeping started (the first time query)
 unsigned long uptimeMs();
 
-// Return the number of microseconds since the program started
+// Return the number of microseconds since timekeeping started (the first time query)
 unsigned long uptimeUs();
 
-// sleep for a specified number of milliseconds
+// sleep for a specified number of milliseconds, deferred work (Work.h) runs meanwhile and can extend it
 void sleep(unsigned long ms);
 
 // Sleep for a specified number of microseconds
@@ -69,17 +90,26 @@ void sleepMicroseconds(unsigned int us);
 // Configure pin mode (INPUT or OUTPUT)
 int GPIOInit(uint8_t pin, uint8_t mode);
 
-// Overloaded versions of GPIOControl for DIGITALREAD and ANALOGREAD without mode parameter
+// Overloaded versions of GPIOControl for DIGITALREAD and ANALOGREAD without mode parameter,
+// ANALOGREAD returns -1 while Comparator_begin uses the ADC multiplexer
 int GPIORead(uint8_t pin, uint8_t state);
 // Write to a digital pin
 uint8_t GPIOWrite(uint8_t pin, uint8_t mode, uint8_t value = 0);
 // Control GPIO states
 int GPIOControl(uint8_t pin, uint8_t mode, uint8_t value = 0);
 
-// Initialize Serial communication
-void Serial_begin(unsigned long baud);
+// Initialize Serial communication, returns 0 if the baud rate is out of tolerance
+int Serial_begin(unsigned long baud);
+// Baud rate error of the last Serial_begin, in hundredths of a percent
+int16_t Serial_baudError();
 // Write data to Serial
 void Serial_write(const char* str);
+// Queue a byte for interrupt-driven transmit, waits while the buffer is full
+void Serial_queue(uint8_t c);
+// Number of free bytes in the Serial transmit buffer
+uint8_t Serial_txFree();
+// Wait until all queued bytes have been sent
+void Serial_flush();
 
 // Write data to Serial with newline conversion
 void Serial_print(const char* str);
@@ -88,8 +118,66 @@ void Serial_println(const char* str = "");
 // FOrmatted print to Serial with dynamic buffer
 void Serial_printf(const char *format, ...);
 
+// Write a flash-resident (PROGMEM) string to Serial with newline conversion
+void Serial_print_P(PGM_P str);
+// Write a flash-resident string to Serial with newline
+void Serial_println_P(PGM_P str);
+// Formatted print to Serial with a flash-resident format string
+void Serial_printf_P(PGM_P format, ...);
+
 #ifdef __cplusplus
 }
+
+// Marker type for string literals kept in flash, see F()
+class __FlashStringHelper;
+// Keep a string literal in flash instead of copying it to SRAM at startup
+#define F(string_literal) (reinterpret_cast<const __FlashStringHelper *>(PSTR(string_literal)))
+
+// UBRR value closest to the requested baud rate for a clock divisor of 16 (normal) or 8 (U2X)
+constexpr unsigned long __SerialUbrr__(unsigned long baud, unsigned long div) {
+    return ((F_CPU + div * baud / 2) / (div * baud) == 0) ? 0 :
+           ((F_CPU + div * baud / 2) / (div * baud) > 4096UL) ? 4095UL :
+           (F_CPU + div * baud / 2) / (div * baud) - 1;
+}
+
+// Baud rate error for a clock divisor and UBRR value, in hundredths of a percent
+constexpr long __SerialBaudError__(unsigned long baud, unsigned long div, unsigned long ubrr) {
+    return ((long)((F_CPU + div * (ubrr + 1) / 2) / (div * (ubrr + 1))) - (long)baud) * 100 / (long)(baud / 100);
+}
+
+constexpr long __SerialAbs__(long value) {
+    return value < 0 ? -value : value;
+}
+
+// Pick normal or double-speed mode, whichever has the lower error (normal mode on a tie)
+constexpr uint16_t __SerialBaudSetting__(unsigned long baud) {
+    return (__SerialAbs__(__SerialBaudError__(baud, 16, __SerialUbrr__(baud, 16))) <=
+            __SerialAbs__(__SerialBaudError__(baud, 8, __SerialUbrr__(baud, 8))))
+        ? (uint16_t)__SerialUbrr__(baud, 16)
+        : (uint16_t)(SERIAL_U2X_FLAG | __SerialUbrr__(baud, 8));
+}
+
+// Baud rate error of a setting returned by __SerialBaudSetting__
+constexpr long __SerialSettingError__(unsigned long baud, uint16_t setting) {
+    return __SerialBaudError__(baud, (setting & SERIAL_U2X_FLAG) ? 8 : 16, setting & ~SERIAL_U2X_FLAG);
+}
+
+// Program the USART with a baud setting (U2X flag + UBRR) and its error
+int __SerialApplyBaud__(uint16_t setting, int16_t error);
+
+// Initialize Serial communication with a constant baud rate, checked at compile time
+template <unsigned long BAUD>
+inline int Serial_begin() {
+    static_assert(BAUD >= 100, "Serial_begin: baud rate too low");
+    static_assert(__SerialAbs__(__SerialSettingError__(BAUD, __SerialBaudSetting__(BAUD))) <= SERIAL_BAUD_TOLERANCE,
+                  "Serial_begin: baud rate error out of tolerance at this F_CPU");
+    return __SerialApplyBaud__(__SerialBaudSetting__(BAUD), __SerialSettingError__(BAUD, __SerialBaudSetting__(BAUD)));
+}
+
+// Overloads of the Serial functions for F("...") strings
+void Serial_print(const __FlashStringHelper *str);
+void Serial_println(const __FlashStringHelper *str);
+void Serial_printf(const __FlashStringHelper *format, ...);
 #endif
 
 #endif
@@ -0,0 +1,65 @@
+#ifndef AVRLiteConfig_h
+#define AVRLiteConfig_h
+
+/**
+ * Build configuration of the avrlite library. Every option can also be given on the
+ * compiler command line (-DAVRLITE_USE_TWI=0) instead of editing this file.
+ */
+
+// Optional modules, set to 0 to leave a module out of the library entirely (its ISRs too).
+// Timekeeping, GPIO, Serial and Power are always built.
+#ifndef AVRLITE_USE_TELEMETRY
+#define AVRLITE_USE_TELEMETRY 1
+#endif
+#ifndef AVRLITE_USE_TWI
+#define AVRLITE_USE_TWI 1
+#endif
+#ifndef AVRLITE_USE_SPI
+#define AVRLITE_USE_SPI 1
+#endif
+#ifndef AVRLITE_USE_EEPROM
+#define AVRLITE_USE_EEPROM 1
+#endif
+#ifndef AVRLITE_USE_WS2812
+#define AVRLITE_USE_WS2812 1
+#endif
+#ifndef AVRLITE_USE_ICP
+#define AVRLITE_USE_ICP 1
+#endif
+#ifndef AVRLITE_USE_ENCODER
+#define AVRLITE_USE_ENCODER 1
+#endif
+#ifndef AVRLITE_USE_FIXEDPOINT
+#define AVRLITE_USE_FIXEDPOINT 1
+#endif
+#ifndef AVRLITE_USE_MEMORY
+#define AVRLITE_USE_MEMORY 1
+#endif
+#ifndef AVRLITE_USE_COMMAND
+#define AVRLITE_USE_COMMAND 1
+#endif
+#ifndef AVRLITE_USE_SCAN
+#define AVRLITE_USE_SCAN 1
+#endif
+#ifndef AVRLITE_USE_COMPARATOR
+#define AVRLITE_USE_COMPARATOR 1
+#endif
+#ifndef AVRLITE_USE_WORK
+#define AVRLITE_USE_WORK 1
+#endif
+
+// Instrumentation, off by default (also the CMake options of the same name)
+// #define AVRLITE_PROFILE
+// #define AVRLITE_TRACE
+
+// Buffer sizes, defaults are in the module headers
+// #define SERIAL_TX_BUFFER_SIZE 64
+// #define TELEMETRY_MAX_FRAME   48
+// #define EEPROM_CACHE_SIZE     16
+// #define ICP_BUFFER_SIZE       16
+// #define TRACE_BUFFER_SIZE     32
+// #define COMMAND_LINE_SIZE     48
+// #define SCAN_MAX_ROWS         8
+// #define WORK_QUEUE_SIZE       8
+
+#endif
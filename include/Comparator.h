@@ -0,0 +1,58 @@
+#ifndef Comparator_h
+#define Comparator_h
+
+#include "AVRLite.h"
+#include "ICP.h"
+
+// Positive input: AIN0 (D6) or the internal 1.1 V bandgap
+#define COMPARATOR_BANDGAP 0xFF
+
+// Edges for Comparator_begin (the ACIS1:0 values), the output is high while positive > negative
+#define COMPARATOR_TOGGLE  0x0  // Both edges, periods are taken between rising edges
+#define COMPARATOR_FALLING 0x2
+#define COMPARATOR_RISING  0x3
+
+// Options for Comparator_begin
+#define COMPARATOR_CAPTURE      0x10  // Timestamp edges in hardware on Timer1 input capture (uses ICP.h),
+                                      // every edge is captured so the input needs hysteresis
+#define COMPARATOR_NOISE_CANCEL 0x20  // With COMPARATOR_CAPTURE: require 4 equal samples (ICNC1)
+
+// Called from the comparator interrupt with the output level after the edge
+typedef void (*Comparator_Callback)(uint8_t level);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Compare positive (D6 or COMPARATOR_BANDGAP) against negative (D7, or A0-A5 through the ADC
+// multiplexer) and timestamp the selected edges. Returns 0 for a bad input or edge. The multiplexer
+// keeps the ADC disabled, so GPIORead(..., ANALOGREAD) returns -1 until Comparator_end.
+uint8_t Comparator_begin(uint8_t positive, uint8_t negative, uint8_t mode);
+// Switch the comparator off (ACD) and release its inputs
+void Comparator_end();
+
+// Current output level, 1 while positive > negative
+uint8_t Comparator_read();
+
+// Call back on every accepted edge, NULL to stop. With COMPARATOR_CAPTURE this also enables the
+// comparator interrupt, which timestamps in software only for the holdoff.
+void Comparator_onEdge(Comparator_Callback callback);
+// Ignore edges closer than counts Timer1 counts to the previous one (chatter near the threshold)
+void Comparator_setHoldoff(unsigned long counts);
+
+// Edges accepted by the comparator interrupt since Comparator_begin, e.g. to detect a lost signal
+// (with COMPARATOR_CAPTURE only while a callback is set)
+unsigned long Comparator_edges();
+// Latest period between selected edges, in Timer1 counts, 0 before two edges were seen
+unsigned long Comparator_period();
+// Timestamp of the latest edge that started a period, in Timer1 counts (ICP_now time base)
+unsigned long Comparator_lastEdge();
+// Frequency from the latest period in hundredths of Hz, 0 before two edges were seen
+unsigned long Comparator_frequency();
+// Phase of a Timer1 timestamp (e.g. ICP_now()) within the current period, 65536 = one full cycle
+uint16_t Comparator_phase(unsigned long timestamp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+#include "Encoder.h"
+
+#if AVRLITE_USE_ENCODER
+
+// Step for each (previous AB << 2 | current AB) transition, 2 marks an illegal transition
+static const int8_t encoder_table[16] PROGMEM = {
+     0, -1,  1,  2,
+     1,  0,  2, -1,
+    -1,  2,  0,  1,
+     2,  1, -1,  0
+};
+
+typedef struct {
+    uint8_t portA, maskA;   // Port index (0 = PINB, 1 = PINC, 2 = PIND) and bit of input A
+    uint8_t portB, maskB;
+    uint8_t state;          // Previous AB
+    volatile long count;
+    volatile unsigned long errors;
+    long lastCount;         // Velocity window
+    unsigned long lastTime;
+} __Encoder__;
+
+static __Encoder__ encoders[ENCODER_MAX];
+static volatile uint8_t encoder_count;
+
+// Port index and bit mask of a pin, for the PINx snapshot in the ISR
+static uint8_t __EncoderPort__(uint8_t pin, uint8_t *mask) {
+    if (pin <= 7)   { *mask = 1 << pin;        return 2; }
+    if (pin <= 13)  { *mask = 1 << (pin - 8);  return 0; }
+    *mask = 1 << (pin - 14);
+    return 1;
+}
+
+// Enable the pin change interrupt of a pin
+static void __EncoderEnablePCINT__(uint8_t pin) {
+    if (pin <= 7) {
+        PCMSK2 |= (1 << pin);
+        PCICR |= (1 << PCIE2);
+    } else if (pin <= 13) {
+        PCMSK0 |= (1 << (pin - 8));
+        PCICR |= (1 << PCIE0);
+    } else {
+        PCMSK1 |= (1 << (pin - 14));
+        PCICR |= (1 << PCIE1);
+    }
+}
+
+// Interrupt Service Routine (ISR) for pin changes, decodes every encoder in one pass
+ISR(PCINT0_vect) {
+    // One snapshot of all ports, so A and B of each encoder are read together
+    uint8_t pins[3] = {PINB, PINC, PIND};
+    uint8_t n = encoder_count;
+
+    for (uint8_t i = 0; i < n; i++) {
+        __Encoder__ *e = &encoders[i];
+        uint8_t ab = ((pins[e->portA] & e->maskA) ? 2 : 0) | ((pins[e->portB] & e->maskB) ? 1 : 0);
+        int8_t step = pgm_read_byte(&encoder_table[(e->state << 2) | ab]);
+        e->state = ab;
+
+        if (step == 2)
+            e->errors++;
+        else
+            e->count += step;
+    }
+}
+ISR(PCINT1_vect, ISR_ALIASOF(PCINT0_vect));
+ISR(PCINT2_vect, ISR_ALIASOF(PCINT0_vect));
+
+// Attach a quadrature encoder to any two pins, returns its id or -1 if none is free
+int Encoder_begin(uint8_t pinA, uint8_t pinB) {
+    if (encoder_count >= ENCODER_MAX || pinA > D19 || pinB > D19)
+        return -1;
+
+    // Inputs with pull-ups
+    GPIOInit(pinA, INPUT);
+    GPIOInit(pinB, INPUT);
+    GPIOWrite(pinA, HIGH);
+    GPIOWrite(pinB, HIGH);
+
+    uint8_t id = encoder_count;
+    __Encoder__ *e = &encoders[id];
+    e->portA = __EncoderPort__(pinA, &e->maskA);
+    e->portB = __EncoderPort__(pinB, &e->maskB);
+    e->state = (GPIORead(pinA, DIGITALREAD) << 1) | GPIORead(pinB, DIGITALREAD);
+    e->count = 0;
+    e->errors = 0;
+    e->lastCount = 0;
+    e->lastTime = uptimeUs();
+
+    cli();
+    encoder_count = id + 1;
+    __EncoderEnablePCINT__(pinA);
+    __EncoderEnablePCINT__(pinB);
+    // Decoding runs in the pin change interrupts
+    sei();
+
+    return id;
+}
+
+// Current position in quadrature steps (4 per encoder cycle)
+long Encoder_read(uint8_t id) {
+    long count;
+    uint8_t oldSREG = SREG;
+    cli();
+    count = encoders[id].count;
+    SREG = oldSREG;
+    return count;
+}
+
+// Set the position
+void Encoder_write(uint8_t id, long count) {
+    uint8_t oldSREG = SREG;
+    cli();
+    encoders[id].count = count;
+    encoders[id].lastCount = count;
+    SREG = oldSREG;
+}
+
+// Number of illegal transitions (both inputs changed at once, i.e. missed steps)
+unsigned long Encoder_errors(uint8_t id) {
+    unsigned long errors;
+    uint8_t oldSREG = SREG;
+    cli();
+    errors = encoders[id].errors;
+    SREG = oldSREG;
+    return errors;
+}
+
+// Steps per second since the previous call, measured with uptimeUs()
+long Encoder_velocity(uint8_t id) {
+    __Encoder__ *e = &encoders[id];
+    unsigned long now = uptimeUs();
+    long count = Encoder_read(id);
+    // Elapsed time in units of 64 us, 1e6 / 64 = 15625 units per second
+    long elapsed = (now - e->lastTime) >> 6;
+
+    if (elapsed == 0)
+        return 0;
+
+    long steps = count - e->lastCount;
+    e->lastCount = count;
+    e->lastTime = now;
+
+    // steps * 15625 overflows past 137438 steps, so whole steps per unit and the remainder are
+    // scaled separately. The remainder is below elapsed; both are halved until it fits, which
+    // only happens when the calls are more than 8.8 s apart.
+    long whole = steps / elapsed, rest = steps % elapsed;
+    while (rest > 137438L || rest < -137438L) {
+        rest /= 2;
+        elapsed /= 2;
+    }
+    return whole * 15625L + rest * 15625L / elapsed;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef Encoder_h
+#define Encoder_h
+
+#include "AVRLite.h"
+
+// Maximum number of encoders
+#ifndef ENCODER_MAX
+#define ENCODER_MAX 4
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Attach a quadrature encoder to any two pins, returns its id or -1 if none is free
+int Encoder_begin(uint8_t pinA, uint8_t pinB);
+
+// Current position in quadrature steps (4 per encoder cycle)
+long Encoder_read(uint8_t id);
+// Set the position
+void Encoder_write(uint8_t id, long count);
+// Number of illegal transitions (both inputs changed at once, i.e. missed steps)
+unsigned long Encoder_errors(uint8_t id);
+// Steps per second since the previous call, measured with uptimeUs()
+long Encoder_velocity(uint8_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,193 @@
+#include "ICP.h"
+#include "RingBuffer.h"
+
+#if AVRLITE_USE_ICP
+
+static RingBuffer<ICP_Capture, ICP_BUFFER_SIZE> icp_buffer;
+static volatile unsigned int icp_overruns;
+static uint8_t icp_mode;
+
+// Upper 16 bits of the capture timestamps
+static volatile uint16_t icp_wraps;
+// ICP_TIMEBASE_ flags of the modules that need icp_wraps counted
+static uint8_t icp_timebase_users;
+
+static unsigned long icp_last_edge;
+static volatile unsigned long icp_period;
+static volatile unsigned long icp_pulse_width;
+static uint8_t icp_edges;
+
+// Interrupt Service Routine (ISR) for Timer1 overflow, extends timestamps past 16 bits
+ISR(TIMER1_OVF_vect) {
+    icp_wraps++;
+}
+
+// Interrupt Service Routine (ISR) for Timer1 input capture
+ISR(TIMER1_CAPT_vect) {
+    uint16_t icr = ICR1;
+    uint16_t wraps = icp_wraps;
+    uint8_t edge = (TCCR1B & (1 << ICES1)) ? ICP_RISING : ICP_FALLING;
+
+    // An overflow still pending with a small capture value happened before the capture
+    if ((TIFR1 & (1 << TOV1)) && icr < 0x8000)
+        wraps++;
+    unsigned long timestamp = ((unsigned long)wraps << 16) | icr;
+
+    if (icp_mode == ICP_BOTH) {
+        // Capture the other edge next, changing ICES1 can set ICF1 so clear it
+        TCCR1B ^= (1 << ICES1);
+        TIFR1 = (1 << ICF1);
+    }
+
+    // Period between edges of the selected kind (rising edges for ICP_BOTH)
+    if (icp_mode == ICP_BOTH && edge == ICP_FALLING) {
+        if (icp_edges)
+            icp_pulse_width = timestamp - icp_last_edge;
+    } else {
+        if (icp_edges)
+            icp_period = timestamp - icp_last_edge;
+        icp_last_edge = timestamp;
+        icp_edges = 1;
+    }
+
+    // Buffer the capture for ICP_read
+    ICP_Capture capture = {timestamp, edge};
+    if (!icp_buffer.push(capture))
+        icp_overruns++;
+}
+
+// Count Timer1 overflows for ICP_now on behalf of a user (ICP_TIMEBASE_ flag)
+void __ICPTimebase__(uint8_t user) {
+    __TimeBegin__();
+    uint8_t oldSREG = SREG;
+    cli();
+    icp_timebase_users |= user;
+    if (!(TIMSK1 & (1 << TOIE1))) {
+        TIFR1 = (1 << TOV1);
+        TIMSK1 |= (1 << TOIE1);
+    }
+    SREG = oldSREG;
+}
+
+// Drop a user of the time base, the overflow interrupt stops with the last one
+void __ICPTimebaseRelease__(uint8_t user) {
+    uint8_t oldSREG = SREG;
+    cli();
+    icp_timebase_users &= ~user;
+    if (!icp_timebase_users)
+        TIMSK1 &= ~(1 << TOIE1);
+    SREG = oldSREG;
+}
+
+// Start capturing edges on ICP1 (D8)
+void ICP_begin(uint8_t mode) {
+    // With ACIC set the analog comparator drives the capture unit and D8 stays free
+    if (!(ACSR & (1 << ACIC)))
+        GPIOInit(D8, INPUT);
+    // Timestamps come from the free-running Timer1, extended by the overflow count
+    __ICPTimebase__(ICP_TIMEBASE_CAPTURE);
+
+    cli();
+
+    icp_mode = mode & ICP_BOTH;
+    icp_buffer.clear();
+    icp_overruns = 0;
+    icp_period = icp_pulse_width = 0;
+    icp_edges = 0;
+
+    // Timer1 already runs free at F_CPU for uptimeMs, only the capture unit is set up here
+    TCCR1B &= ~((1 << ICES1) | (1 << ICNC1));
+    if (icp_mode != ICP_FALLING)
+        TCCR1B |= (1 << ICES1);
+    if (mode & ICP_NOISE_CANCEL)
+        TCCR1B |= (1 << ICNC1);
+
+    // TOV1 is left alone, another time base user may have an overflow pending
+    TIFR1 = (1 << ICF1);
+    TIMSK1 |= (1 << ICIE1);
+
+    // Captures are taken in TIMER1_CAPT_vect
+    sei();
+}
+
+// Stop capturing, the overflow count keeps running while the Comparator still uses ICP_now
+void ICP_end() {
+    uint8_t oldSREG = SREG;
+    cli();
+    TIMSK1 &= ~(1 << ICIE1);
+    SREG = oldSREG;
+    __ICPTimebaseRelease__(ICP_TIMEBASE_CAPTURE);
+}
+
+// Number of captures waiting in the buffer
+uint8_t ICP_available() {
+    return icp_buffer.size();
+}
+
+// Take the oldest capture from the buffer, returns 0 if it is empty
+uint8_t ICP_read(ICP_Capture *capture) {
+    return icp_buffer.pop(*capture);
+}
+
+// Number of captures lost because the buffer was full
+unsigned int ICP_overruns() {
+    unsigned int overruns;
+    uint8_t oldSREG = SREG;
+    cli();
+    overruns = icp_overruns;
+    SREG = oldSREG;
+    return overruns;
+}
+
+// Latest period between rising edges, in Timer1 counts
+unsigned long ICP_period() {
+    unsigned long period;
+    uint8_t oldSREG = SREG;
+    cli();
+    period = icp_period;
+    SREG = oldSREG;
+    return period;
+}
+
+// Latest high time (ICP_BOTH only), in Timer1 counts
+unsigned long ICP_pulseWidth() {
+    unsigned long width;
+    uint8_t oldSREG = SREG;
+    cli();
+    width = icp_pulse_width;
+    SREG = oldSREG;
+    return width;
+}
+
+// Frequency from the latest period in Hz, 0 before two edges were seen
+unsigned long ICP_frequency() {
+    unsigned long period = ICP_period();
+    if (period == 0)
+        return 0;
+    return (F_CPU + period / 2) / period;
+}
+
+// Timestamp of the latest edge that started a period, in Timer1 counts
+unsigned long ICP_lastEdge() {
+    unsigned long edge;
+    uint8_t oldSREG = SREG;
+    cli();
+    edge = icp_last_edge;
+    SREG = oldSREG;
+    return edge;
+}
+
+// Current 32-bit Timer1 count, on the same time base as the capture timestamps
+unsigned long ICP_now() {
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t count = TCNT1;
+    uint16_t wraps = icp_wraps;
+    // Same correction as the capture ISR for an overflow not yet handled
+    if ((TIFR1 & (1 << TOV1)) && count < 0x8000)
+        wraps++;
+    SREG = oldSREG;
+    return ((unsigned long)wraps << 16) | count;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef Memory_h
+#define Memory_h
+
+#include "AVRLite.h"
+
+// Byte painted over free RAM at startup, the stack overwrites it as it grows
+#define MEMORY_SENTINEL 0xC5
+
+// Sentinel bytes in a row that start the untouched gap above the heap. free() lowers the heap end
+// but leaves the freed block's contents behind, and shorter runs in there are not the gap.
+#ifndef MEMORY_SENTINEL_RUN
+#define MEMORY_SENTINEL_RUN 8
+#endif
+
+// Default guard band between the heap and the lowest stack address, in bytes
+#ifndef MEMORY_GUARD_BYTES
+#define MEMORY_GUARD_BYTES 32
+#endif
+
+// RAM usage snapshot, all sizes in bytes
+typedef struct {
+    uint16_t staticSize;    // .data + .bss
+    uint16_t heapSize;      // Heap end minus heap start, including freed blocks
+    uint16_t heapFree;      // Bytes in the malloc free list
+    uint16_t heapLargest;   // Largest block in the free list
+    uint8_t fragmentation;  // Percent of free heap not in the largest block
+    uint16_t stackSize;     // Current stack depth
+    uint16_t stackMax;      // Deepest stack seen since reset (high-water mark)
+    uint16_t freeNow;       // Between heap end and stack pointer
+    uint16_t freeMin;       // Between heap end and the deepest stack, never touched
+} MemoryStats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Fill `stats` with the current RAM usage
+void Memory_stats(MemoryStats *stats);
+// Print the RAM usage as one line over Serial
+void Memory_report();
+
+// Call `handler` from Memory_check when less than `bytes` stay untouched between heap and stack
+void Memory_setGuard(uint16_t bytes, void (*handler)(uint16_t freeMin));
+// Check the guard band, returns 1 (and calls the handler) if it was breached
+uint8_t Memory_check();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,80 @@
+#include "Power.h"
+
+// Startup: clock-gate every peripheral, modules power up what they use. Linked into every
+// image (-u __initPower__), interrupts stay off until a module that needs them starts.
+extern "C" void __attribute__((constructor)) __initPower__() {
+    PRR = POWER_ALL;
+    // The analog comparator is not in PRR, switch it off as well
+    ACSR |= (1 << ACD);
+}
+
+// Power down peripherals (POWER_ flags), the ADC is disabled first so it stops drawing current
+void Power_disable(uint8_t modules) {
+    uint8_t oldSREG = SREG;
+    cli();
+    if ((modules & POWER_ADC) && !(PRR & POWER_ADC))
+        ADCSRA &= ~(1 << ADEN);
+    PRR |= modules & POWER_ALL;
+    SREG = oldSREG;
+}
+
+// Sleep until an interrupt
+void Power_sleep(uint8_t mode) {
+    set_sleep_mode(mode);
+    cli();
+    sleep_enable();
+    // The brown-out detector only draws current that matters in the deepest modes
+    if (mode == SLEEP_MODE_PWR_DOWN || mode == SLEEP_MODE_PWR_SAVE)
+        sleep_bod_disable();
+    // The instruction after sei is always executed, so no interrupt is lost before sleeping
+    sei();
+    sleep_cpu();
+    sleep_disable();
+}
+
+// Stop the CPU clock until the next interrupt
+void Power_idle() {
+    Power_sleep(SLEEP_MODE_IDLE);
+}
+
+// Idle until the next interrupt if busy() still holds with interrupts off
+uint8_t Power_idleIf(uint8_t (*busy)()) {
+    uint8_t oldSREG = SREG;
+    cli();
+    uint8_t result = busy();
+    if (result && (oldSREG & (1 << SREG_I))) {
+        set_sleep_mode(SLEEP_MODE_IDLE);
+        sleep_enable();
+        // sei and sleep back to back: an interrupt pending since the check wakes the CPU at once
+        sei();
+        sleep_cpu();
+        sleep_disable();
+    }
+    SREG = oldSREG;
+    return result;
+}
+
+// Interrupt Service Routine (ISR) for the watchdog, only wakes the CPU
+ISR(WDT_vect) {
+}
+
+// Set the watchdog control register, a timed sequence
+static void __PowerWatchdog__(uint8_t control) {
+    wdt_reset();
+    MCUSR &= ~(1 << WDRF);
+    WDTCSR = (1 << WDCE) | (1 << WDE);
+    WDTCSR = control;
+}
+
+// Power down for a watchdog period, uptime does not advance meanwhile
+void Power_powerDown(uint8_t period) {
+    uint8_t oldSREG = SREG;
+    cli();
+    // Interrupt mode only, so the watchdog wakes the CPU instead of resetting it
+    __PowerWatchdog__((1 << WDIE) | (period & 0x07) | ((period & 0x08) ? (1 << WDP3) : 0));
+    Power_sleep(SLEEP_MODE_PWR_DOWN);
+
+    cli();
+    __PowerWatchdog__(0);
+    SREG = oldSREG;
+}
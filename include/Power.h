@@ -0,0 +1,55 @@
+#ifndef Power_h
+#define Power_h
+
+#include "AVRLite.h"
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+
+// Peripherals that can be clock-gated through PRR. At startup all of them are off and global
+// interrupts are disabled; timekeeping powers Timer0 and Timer1 on the first time query and the
+// other modules power themselves up on first use.
+#define POWER_ADC    (1 << PRADC)
+#define POWER_USART0 (1 << PRUSART0)
+#define POWER_SPI    (1 << PRSPI)
+#define POWER_TIMER1 (1 << PRTIM1)
+#define POWER_TIMER0 (1 << PRTIM0)
+#define POWER_TIMER2 (1 << PRTIM2)
+#define POWER_TWI    (1 << PRTWI)
+#define POWER_ALL    (POWER_ADC | POWER_USART0 | POWER_SPI | POWER_TIMER1 | POWER_TIMER0 | POWER_TIMER2 | POWER_TWI)
+
+// Power up peripherals (POWER_ flags), their registers are only accessible while powered
+static inline void Power_enable(uint8_t modules) {
+    uint8_t oldSREG = SREG;
+    cli();
+    PRR &= ~modules;
+    SREG = oldSREG;
+}
+
+// Peripherals currently powered (POWER_ flags)
+static inline uint8_t Power_enabled() {
+    return ~PRR & POWER_ALL;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Power down peripherals (POWER_ flags), the ADC is disabled first so it stops drawing current
+void Power_disable(uint8_t modules);
+
+// Sleep until an interrupt: SLEEP_MODE_IDLE, SLEEP_MODE_ADC, SLEEP_MODE_PWR_DOWN,
+// SLEEP_MODE_PWR_SAVE, SLEEP_MODE_STANDBY or SLEEP_MODE_EXT_STANDBY
+void Power_sleep(uint8_t mode);
+// Stop the CPU clock until the next interrupt. Once timekeeping has started and interrupts are on
+// the timers wake it at least every millisecond; before that only a module's interrupt does, so
+// waits on a condition use Power_idleIf.
+void Power_idle();
+// Idle until the next interrupt if busy() still holds with interrupts off, so the interrupt that
+// clears it cannot run between the check and sleeping. Returns busy(), never sleeps with I clear.
+uint8_t Power_idleIf(uint8_t (*busy)());
+// Power down for a watchdog period (WDTO_15MS to WDTO_8S), uptime does not advance meanwhile
+void Power_powerDown(uint8_t period);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef Profile_h
+#define Profile_h
+
+#include "AVRLite.h"
+
+/**
+ * Cycle-accurate profiling probes on the free-running Timer1 counter (one count per CPU cycle).
+ * Build with -DAVRLITE_PROFILE to enable them; otherwise every macro below expands to nothing.
+ * A single measurement must stay below 65536 cycles (4 ms at 16 MHz).
+ *
+ * A probe is not free: two atomic TCNT1 reads, then a cli section that compares and updates the
+ * 16-bit min/max and adds to the 32-bit total and count, tens of cycles added to the instrumented
+ * code (avrlite_bench reports it as Profile_probe). Only the counter reads fall inside the
+ * measurement, and Profile_read subtracts them.
+ *
+ * Timer1 only counts once timekeeping has started. Profile_reset() and Profile_name() start it;
+ * without one of them (or a time query) first, every sample is 0.
+ */
+
+// Number of probes, including the built-in ones
+#ifndef PROFILE_PROBES
+#define PROFILE_PROBES 8
+#endif
+
+// Built-in probes for the library's timer interrupts, application probes start at PROFILE_USER
+#define PROFILE_TIMER0 0
+#define PROFILE_TIMER1 1
+#define PROFILE_TIMER2 2
+#define PROFILE_USER   3
+
+// Statistics of one probe, in CPU cycles
+typedef struct {
+    unsigned long count;
+    unsigned long total;
+    uint16_t min;
+    uint16_t max;
+} Profile_Probe;
+
+#ifdef AVRLITE_PROFILE
+
+extern Profile_Probe profile_probes[PROFILE_PROBES];
+extern uint16_t profile_latency_min, profile_latency_max;
+
+// Timer1 count, read atomically (TCNT1 shares the TEMP register with the other 16-bit registers)
+static inline uint16_t __profileCounter__() {
+    uint8_t oldSREG = SREG;
+    cli();
+    uint16_t count = TCNT1;
+    SREG = oldSREG;
+    return count;
+}
+
+// Inline so that instrumented ISRs do not have to save every call-clobbered register
+static inline void __profileRecord__(uint8_t id, uint16_t cycles) {
+    Profile_Probe *probe = &profile_probes[id];
+    uint8_t oldSREG = SREG;
+    cli();
+    if (probe->count == 0 || cycles < probe->min)
+        probe->min = cycles;
+    if (cycles > probe->max)
+        probe->max = cycles;
+    probe->total += cycles;
+    probe->count++;
+    SREG = oldSREG;
+}
+
+static inline void __profileLatency__(uint16_t cycles) {
+    if (cycles < profile_latency_min)
+        profile_latency_min = cycles;
+    if (cycles > profile_latency_max)
+        profile_latency_max = cycles;
+}
+
+#ifdef __cplusplus
+// Measures the enclosing scope, from construction to destruction
+class __ProfileScope__ {
+public:
+    __ProfileScope__(uint8_t id) : id(id), start(__profileCounter__()) {}
+    ~__ProfileScope__() { __profileRecord__(id, __profileCounter__() - start); }
+
+private:
+    uint8_t id;
+    uint16_t start;
+};
+
+// Profile the rest of the enclosing block (function, ISR or loop body)
+#define PROFILE_SCOPE(id) __ProfileScope__ __profileScope(id)
+#endif
+
+// Profile the code between PROFILE_BEGIN() and PROFILE_END(id), one pair per block
+#define PROFILE_BEGIN()        uint16_t __profileStart = __profileCounter__()
+#define PROFILE_END(id)        __profileRecord__((id), __profileCounter__() - __profileStart)
+// Record the delay from an interrupt request to its handler, e.g. TCNT1 - OCR1A in a compare ISR
+#define PROFILE_LATENCY(cycles) __profileLatency__(cycles)
+// Name a probe for Profile_dump, `name` is a string literal
+#define PROFILE_NAME(id, name) Profile_name((id), PSTR(name))
+#define PROFILE_DUMP()         Profile_dump()
+#define PROFILE_RESET()        Profile_reset()
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Name a probe for Profile_dump (string in flash)
+void Profile_name(uint8_t id, PGM_P name);
+// Copy the statistics of a probe, with the probe overhead already subtracted
+void Profile_read(uint8_t id, Profile_Probe *probe);
+// Print all probes that have samples and the interrupt latency as a table over Serial
+void Profile_dump();
+// Clear all statistics
+void Profile_reset();
+#ifdef __cplusplus
+}
+#endif
+
+#else
+
+#define PROFILE_SCOPE(id)
+#define PROFILE_BEGIN()
+#define PROFILE_END(id)
+#define PROFILE_LATENCY(cycles)
+#define PROFILE_NAME(id, name)
+#define PROFILE_DUMP()
+#define PROFILE_RESET()
+
+#endif
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef RingBuffer_h
+#define RingBuffer_h
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * Lock-free single-producer/single-consumer ring buffer.
+ *
+ * One side (e.g. an ISR) only pushes, the other (e.g. the main loop) only pops. Each index is a
+ * single byte owned by one side, so loads and stores are atomic on AVR and no interrupts are
+ * disabled. N must be a power of two up to 128; indices run freely and wrap at 256.
+ *
+ * The cost of push and pop (T = uint8_t, including the full/empty check) is measured under
+ * simavr by the avrlite_bench target as RingBuffer_push and RingBuffer_pop.
+ */
+template <typename T, uint8_t N>
+class RingBuffer {
+    static_assert(N >= 2 && N <= 128 && (N & (N - 1)) == 0, "RingBuffer: N must be a power of two from 2 to 128");
+
+public:
+    RingBuffer() : head(0), tail(0) {}
+
+    // Producer: append an item, returns false if the buffer is full
+    bool push(const T &item) {
+        uint8_t h = head;
+        if ((uint8_t)(h - tail) == N)
+            return false;
+        buffer[h & (N - 1)] = item;
+        __barrier__();
+        head = h + 1;
+        return true;
+    }
+
+    // Consumer: remove the oldest item, returns false if the buffer is empty
+    bool pop(T &item) {
+        uint8_t t = tail;
+        if (t == head)
+            return false;
+        item = buffer[t & (N - 1)];
+        __barrier__();
+        tail = t + 1;
+        return true;
+    }
+
+    // Consumer: oldest item without removing it, or NULL if empty
+    T *peek() {
+        uint8_t t = tail;
+        return (t == head) ? NULL : &buffer[t & (N - 1)];
+    }
+
+    // Either side: the index-th oldest item, or NULL past the newest. From the producer an item the
+    // consumer is still copying (not yet released) is returned too.
+    T *at(uint8_t index) {
+        uint8_t t = tail;
+        return (index < (uint8_t)(head - t)) ? &buffer[(uint8_t)(t + index) & (N - 1)] : NULL;
+    }
+
+    // Producer: append up to `count` items, returns how many fit
+    uint8_t push(const T *items, uint8_t count) {
+        uint8_t done = 0;
+        while (done < count) {
+            uint8_t n;
+            T *span = writeSpan(n);
+            if (n == 0)
+                break;
+            if (n > count - done)
+                n = count - done;
+            memcpy(span, items + done, n * sizeof(T));
+            commitWrite(n);
+            done += n;
+        }
+        return done;
+    }
+
+    // Consumer: remove up to `count` items, returns how many were copied
+    uint8_t pop(T *items, uint8_t count) {
+        uint8_t done = 0;
+        while (done < count) {
+            uint8_t n;
+            const T *span = readSpan(n);
+            if (n == 0)
+                break;
+            if (n > count - done)
+                n = count - done;
+            memcpy(items + done, span, n * sizeof(T));
+            commitRead(n);
+            done += n;
+        }
+        return done;
+    }
+
+    // Producer: contiguous free space to fill in place, publish it with commitWrite
+    T *writeSpan(uint8_t &count) {
+        uint8_t h = head;
+        uint8_t space = N - (uint8_t)(h - tail);
+        uint8_t toEnd = N - (h & (N - 1));
+        count = space < toEnd ? space : toEnd;
+        return &buffer[h & (N - 1)];
+    }
+
+    void commitWrite(uint8_t count) {
+        __barrier__();
+        head = head + count;
+    }
+
+    // Consumer: contiguous items to read in place, release them with commitRead
+    const T *readSpan(uint8_t &count) {
+        uint8_t t = tail;
+        uint8_t used = (uint8_t)(head - t);
+        uint8_t toEnd = N - (t & (N - 1));
+        count = used < toEnd ? used : toEnd;
+        return &buffer[t & (N - 1)];
+    }
+
+    void commitRead(uint8_t count) {
+        __barrier__();
+        tail = tail + count;
+    }
+
+    uint8_t size() const { return (uint8_t)(head - tail); }
+    uint8_t space() const { return N - size(); }
+    bool empty() const { return head == tail; }
+    bool full() const { return size() == N; }
+    static uint8_t capacity() { return N; }
+
+    // Only safe while neither side is running, e.g. with interrupts disabled
+    void clear() { head = tail = 0; }
+
+private:
+    // Keep item accesses on their side of the index update
+    static inline void __barrier__() { asm volatile("" ::: "memory"); }
+
+    T buffer[N];
+    volatile uint8_t head;  // Written by the producer only
+    volatile uint8_t tail;  // Written by the consumer only
+};
+
+/**
+ * Typed message queue on top of RingBuffer: fixed-size slots with a type id and a payload of up
+ * to `Size` bytes. Same single-producer/single-consumer rules as RingBuffer.
+ */
+template <uint8_t N, uint8_t Size>
+class MessageQueue {
+public:
+    struct Message {
+        uint8_t type;
+        uint8_t length;
+        uint8_t data[Size];
+
+        // Payload as a value of type V
+        template <typename V>
+        V as() const {
+            V value;
+            memcpy(&value, data, sizeof(V));
+            return value;
+        }
+    };
+
+    // Producer: post raw bytes, returns false if the queue is full or the payload too long
+    bool post(uint8_t type, const void *data, uint8_t length) {
+        if (length > Size)
+            return false;
+        uint8_t n;
+        Message *slot = queue.writeSpan(n);
+        if (n == 0)
+            return false;
+        slot->type = type;
+        slot->length = length;
+        memcpy(slot->data, data, length);
+        queue.commitWrite(1);
+        return true;
+    }
+
+    // Producer: post a value of any type that fits the payload
+    template <typename V>
+    bool post(uint8_t type, const V &value) {
+        static_assert(sizeof(V) <= Size, "MessageQueue: payload type too large");
+        return post(type, &value, sizeof(V));
+    }
+
+    // Consumer: take the oldest message, returns false if the queue is empty
+    bool receive(Message &message) { return queue.pop(message); }
+
+    // Consumer: oldest message without removing it, then drop it with release
+    const Message *peek() { return queue.peek(); }
+    void release() { queue.commitRead(1); }
+
+    uint8_t size() const { return queue.size(); }
+    bool empty() const { return queue.empty(); }
+
+private:
+    RingBuffer<Message, N> queue;
+};
+
+#endif
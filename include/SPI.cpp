@@ -0,0 +1,212 @@
+#include "SPI.h"
+#include "Power.h"
+
+#if AVRLITE_USE_SPI
+
+// Asynchronous job queue, spi_head is the one on the bus
+static SPI_Job *volatile spi_head;
+static SPI_Job *volatile spi_tail;
+static volatile uint16_t spi_index;
+
+// Initialize the SPI master pins: SCK (D13), MOSI (D11), MISO (D12) and SS (D10)
+void SPI_begin() {
+    // SS must stay an output, otherwise a low level on it drops the SPI out of master mode
+    GPIOWrite(D10, HIGH);
+    GPIOInit(D10, OUTPUT);
+    GPIOInit(D11, OUTPUT);
+    GPIOInit(D12, INPUT);
+    GPIOInit(D13, OUTPUT);
+
+    Power_enable(POWER_SPI);
+    SPCR = (1 << SPE) | (1 << MSTR);
+    // Queued jobs (SPI_submit) run in the transfer complete interrupt
+    sei();
+}
+
+// Describe a device: chip select pin, mode, highest clock it accepts and bit order
+void SPI_device(SPI_Device *device, uint8_t csPin, uint8_t mode, unsigned long clock, uint8_t bitOrder) {
+    // Smallest divider (2 to 128) that does not exceed the requested clock
+    uint8_t shift = 1;
+    while (shift < 7 && (F_CPU >> shift) > clock)
+        shift++;
+
+    // Dividers 2, 8 and 32 are 4, 16 and 64 with double speed (SPI2X)
+    static const uint8_t spr[8] = {0, 0, 0, 1, 1, 2, 2, 3};
+    device->csPin = csPin;
+    device->spcr = (1 << SPE) | (1 << MSTR) | ((mode & 0x3) << CPHA) | (spr[shift]);
+    if (bitOrder == SPI_LSBFIRST)
+        device->spcr |= (1 << DORD);
+    device->spsr = (shift & 1 && shift != 7) ? (1 << SPI2X) : 0;
+
+    GPIOWrite(csPin, HIGH);
+    GPIOInit(csPin, OUTPUT);
+}
+
+// Apply the device settings and pull its chip select low
+void SPI_select(const SPI_Device *device) {
+    SPCR = device->spcr;
+    SPSR = device->spsr;
+    GPIOWrite(device->csPin, LOW);
+}
+
+// Release the chip select
+void SPI_deselect(const SPI_Device *device) {
+    GPIOWrite(device->csPin, HIGH);
+}
+
+// Exchange a single byte
+uint8_t SPI_transfer(uint8_t data) {
+    SPDR = data;
+    while (!(SPSR & (1 << SPIF)));
+    return SPDR;
+}
+
+// Wait for the byte on the wire, then start the next one right away
+#define SPI_WRITE_NEXT(value) do {          \
+        uint8_t next = (value);             \
+        while (!(SPSR & (1 << SPIF)));      \
+        SPDR = next;                        \
+    } while (0)
+
+// Polled burst write, unrolled by four so loop overhead overlaps the shifting byte
+void SPI_write(const uint8_t *data, uint16_t length) {
+    if (length == 0)
+        return;
+
+    SPDR = *data++;
+    length--;
+    while (length >= 4) {
+        SPI_WRITE_NEXT(data[0]);
+        SPI_WRITE_NEXT(data[1]);
+        SPI_WRITE_NEXT(data[2]);
+        SPI_WRITE_NEXT(data[3]);
+        data += 4;
+        length -= 4;
+    }
+    while (length--)
+        SPI_WRITE_NEXT(*data++);
+
+    while (!(SPSR & (1 << SPIF)));
+}
+
+// Polled burst read, clocking out a fill byte
+void SPI_read(uint8_t *data, uint16_t length, uint8_t fill) {
+    if (length == 0)
+        return;
+
+    SPDR = fill;
+    while (--length) {
+        while (!(SPSR & (1 << SPIF)));
+        // Start the next byte first, the receive buffer keeps the previous one
+        SPDR = fill;
+        *data++ = SPDR;
+    }
+    while (!(SPSR & (1 << SPIF)));
+    *data = SPDR;
+}
+
+// Polled burst full-duplex transfer, tx or rx may be NULL
+void SPI_transferBuffer(const uint8_t *tx, uint8_t *rx, uint16_t length) {
+    if (rx == NULL) {
+        SPI_write(tx, length);
+        return;
+    }
+    if (tx == NULL) {
+        SPI_read(rx, length);
+        return;
+    }
+    if (length == 0)
+        return;
+
+    SPDR = *tx++;
+    while (--length) {
+        uint8_t next = *tx++;
+        while (!(SPSR & (1 << SPIF)));
+        SPDR = next;
+        *rx++ = SPDR;
+    }
+    while (!(SPSR & (1 << SPIF)));
+    *rx = SPDR;
+}
+
+// Select the job's device and send its first byte
+static void __SPIStart__(SPI_Job *job) {
+    job->status = SPI_BUSY;
+    spi_index = 0;
+    SPI_select(job->device);
+    SPCR |= (1 << SPIE);
+    SPDR = job->tx ? job->tx[0] : 0xFF;
+}
+
+// Interrupt Service Routine (ISR) for SPI transfer complete
+ISR(SPI_STC_vect) {
+    SPI_Job *job = spi_head;
+    uint16_t index = spi_index;
+
+    if (job == NULL) {
+        SPCR &= ~(1 << SPIE);
+        return;
+    }
+
+    uint8_t in = SPDR;
+    if (job->rx)
+        job->rx[index] = in;
+
+    if (++index < job->length) {
+        SPDR = job->tx ? job->tx[index] : 0xFF;
+        spi_index = index;
+        return;
+    }
+
+    // Job finished, chain the next one
+    SPI_deselect(job->device);
+    spi_head = job->next;
+    if (spi_head == NULL)
+        spi_tail = NULL;
+    job->next = NULL;
+    job->status = SPI_DONE;
+    if (job->callback)
+        job->callback(job);
+
+    // A callback that queued a job on an empty queue has started it already
+    if (spi_head == NULL)
+        SPCR &= ~(1 << SPIE);
+    else if (spi_head->status == SPI_PENDING)
+        __SPIStart__(spi_head);
+}
+
+// Queue an interrupt-driven transfer (selects and deselects the device), returns 0 if already queued
+int SPI_submit(SPI_Job *job) {
+    if (job->status == SPI_PENDING || job->status == SPI_BUSY)
+        return 0;
+
+    if (job->length == 0) {
+        job->status = SPI_DONE;
+        if (job->callback)
+            job->callback(job);
+        return 1;
+    }
+
+    uint8_t oldSREG = SREG;
+    cli();
+
+    job->next = NULL;
+    job->status = SPI_PENDING;
+    if (spi_tail != NULL) {
+        spi_tail->next = job;
+        spi_tail = job;
+    } else {
+        spi_head = spi_tail = job;
+        __SPIStart__(job);
+    }
+
+    SREG = oldSREG;
+    return 1;
+}
+
+// Return 1 while asynchronous jobs are queued or running
+uint8_t SPI_busy() {
+    return spi_head != NULL;
+}
+
+#endif
@@ -0,0 +1,382 @@
+#include "Scan.h"
+#include "RingBuffer.h"
+#include "Power.h"
+#include "Profile.h"
+
+#if AVRLITE_USE_SCAN
+
+// Row (digit) select line: PORTx address and pin bit
+typedef struct {
+    uint8_t port;
+    uint8_t mask;
+} __ScanPin__;
+
+static __ScanPin__ scan_rows[SCAN_MAX_ROWS];
+static uint8_t scan_row_count;
+static uint8_t scan_flags;
+// Without data pins released rows float instead of being driven, so pressing several keys of a
+// column cannot short two row outputs
+static uint8_t scan_rows_float;
+static uint8_t scan_row;
+
+// Data (segment) pins: one PORTx address, the pin bits and the bit of each pattern bit
+static uint8_t scan_data_port;
+static uint8_t scan_data_mask;
+static uint8_t scan_data_bits[8];
+static uint8_t scan_data_count;
+
+// Double buffer of port bits (polarity applied), the ISR shows the front one
+static uint8_t scan_buffers[2][SCAN_MAX_ROWS];
+static volatile uint8_t scan_front;
+static volatile uint8_t scan_swap_pending;
+
+// Keypad columns: PINx address (0 = no keypad), pin bits and column number of each port bit
+static uint8_t scan_column_pin;
+static uint8_t scan_column_mask;
+static uint8_t scan_column_index[8];
+static uint8_t scan_columns;
+
+// Pressed columns per row: this frame, the previous frame and the debounced state
+static uint8_t scan_raw[SCAN_MAX_ROWS];
+static uint8_t scan_last[SCAN_MAX_ROWS];
+static uint8_t scan_stable[SCAN_MAX_ROWS];
+static uint8_t scan_same_frames;
+static volatile unsigned long scan_ghosts;
+static RingBuffer<uint8_t, SCAN_EVENT_BUFFER_SIZE> scan_events;
+
+// 7-segment patterns of '0'-'9' and 'A'-'Z'
+static const uint8_t scan_font[36] PROGMEM = {
+    0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F,
+    0x77, 0x7C, 0x39, 0x5E, 0x79, 0x71, 0x3D, 0x76, 0x30, 0x1E, 0x75, 0x38, 0x37,
+    0x54, 0x5C, 0x73, 0x67, 0x50, 0x6D, 0x78, 0x3E, 0x1C, 0x2A, 0x76, 0x6E, 0x5B
+};
+
+// PORTx address and bit mask of a pin
+static uint8_t __ScanPort__(uint8_t pin, uint8_t *mask) {
+    if (pin <= 7)   { *mask = 1 << pin;        return _SFR_MEM_ADDR(PORTD); }
+    if (pin <= 13)  { *mask = 1 << (pin - 8);  return _SFR_MEM_ADDR(PORTB); }
+    *mask = 1 << (pin - 14);
+    return _SFR_MEM_ADDR(PORTC);
+}
+
+// Port of a pin set (bit n = pin n), or 0 if the pins are not all on one port
+static uint8_t __ScanPinSet__(const uint8_t *pins, uint8_t count, uint8_t *masks, uint8_t *all) {
+    uint8_t port = 0;
+    *all = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (pins[i] > A5)
+            return 0;
+        uint8_t p = __ScanPort__(pins[i], &masks[i]);
+        if (port && p != port)
+            return 0;
+        port = p;
+        *all |= masks[i];
+    }
+    return port;
+}
+
+// Select a row (the DDRx register is one below PORTx)
+static inline void __ScanSelect__(const __ScanPin__ *row) {
+    if (scan_rows_float)
+        _SFR_MEM8(row->port - 1) |= row->mask;
+    if (scan_flags & SCAN_ROW_ACTIVE_LOW)
+        _SFR_MEM8(row->port) &= ~row->mask;
+    else
+        _SFR_MEM8(row->port) |= row->mask;
+}
+
+// Release a row: drive it inactive, or let it float on a keypad without display
+static inline void __ScanRelease__(const __ScanPin__ *row) {
+    if (scan_rows_float) {
+        _SFR_MEM8(row->port - 1) &= ~row->mask;
+        _SFR_MEM8(row->port) &= ~row->mask;
+    } else if (scan_flags & SCAN_ROW_ACTIVE_LOW) {
+        _SFR_MEM8(row->port) |= row->mask;
+    } else {
+        _SFR_MEM8(row->port) &= ~row->mask;
+    }
+}
+
+// End of a frame: reject ghosted readings, debounce and queue key events
+static void __ScanKeys__() {
+    // Two rows sharing two columns form a rectangle: with three of its keys down the fourth reads
+    // as pressed too, so the frame cannot be trusted
+    for (uint8_t a = 0; a < scan_row_count; a++) {
+        uint8_t columns = scan_raw[a];
+        if (!(columns & (columns - 1)))
+            continue;
+        for (uint8_t b = a + 1; b < scan_row_count; b++) {
+            uint8_t shared = columns & scan_raw[b];
+            if (shared & (shared - 1)) {
+                scan_ghosts++;
+                scan_same_frames = 0;
+                return;
+            }
+        }
+    }
+
+    uint8_t same = 1;
+    for (uint8_t row = 0; row < scan_row_count; row++) {
+        if (scan_raw[row] != scan_last[row]) {
+            scan_last[row] = scan_raw[row];
+            same = 0;
+        }
+    }
+    if (!same)
+        scan_same_frames = 0;
+    else if (scan_same_frames < 255)
+        scan_same_frames++;
+    if (scan_same_frames + 1 < SCAN_DEBOUNCE)
+        return;
+
+    for (uint8_t row = 0; row < scan_row_count; row++) {
+        uint8_t changed = scan_last[row] ^ scan_stable[row];
+        if (!changed)
+            continue;
+        for (uint8_t bit = 0; changed; bit++, changed >>= 1) {
+            if (!(changed & 1))
+                continue;
+            uint8_t event = row * scan_columns + scan_column_index[bit];
+            if (!(scan_last[row] & (1 << bit)))
+                event |= SCAN_KEY_RELEASED;
+            scan_events.push(event);
+        }
+        scan_stable[row] = scan_last[row];
+    }
+}
+
+// Interrupt Service Routine (ISR) for Timer2 compare match A, one row per tick
+ISR(TIMER2_COMPA_vect) {
+    PROFILE_SCOPE(PROFILE_TIMER2);
+    uint8_t row = scan_row;
+
+    // The columns had the whole tick to settle on the selected row
+    if (scan_column_pin)
+        scan_raw[row] = ~_SFR_MEM8(scan_column_pin) & scan_column_mask;
+    __ScanRelease__(&scan_rows[row]);
+
+    if (++row == scan_row_count) {
+        row = 0;
+        if (scan_column_pin)
+            __ScanKeys__();
+        // Swap buffers between frames only, never tear a frame
+        if (scan_swap_pending) {
+            scan_front ^= 1;
+            scan_swap_pending = 0;
+        }
+    }
+    scan_row = row;
+
+    // The whole row in one port store, then select it
+    if (scan_data_mask) {
+        uint8_t port = scan_data_port;
+        _SFR_MEM8(port) = (_SFR_MEM8(port) & ~scan_data_mask) | scan_buffers[scan_front][row];
+    }
+    __ScanSelect__(&scan_rows[row]);
+}
+
+// Port bits of a blank row
+static uint8_t __ScanBlank__() {
+    return (scan_flags & SCAN_DATA_ACTIVE_LOW) ? scan_data_mask : 0;
+}
+
+// Start scanning on Timer2 (CTC), one row per tick at frameRate * rows ticks per second
+uint8_t Scan_begin(const uint8_t *rowPins, uint8_t rows, const uint8_t *dataPins, uint8_t dataCount,
+                   uint8_t flags, uint16_t frameRate) {
+    if (rows == 0 || rows > SCAN_MAX_ROWS || dataCount > 8 || frameRate == 0)
+        return 0;
+
+    uint8_t dataBits[8], dataMask;
+    uint8_t dataPort = __ScanPinSet__(dataPins, dataCount, dataBits, &dataMask);
+    if (dataCount && !dataPort)
+        return 0;
+    for (uint8_t i = 0; i < rows; i++) {
+        if (rowPins[i] > A5)
+            return 0;
+    }
+
+    // Smallest prescaler that fits a tick into the 8-bit counter
+    static const uint16_t prescalers[7] PROGMEM = {1, 8, 32, 64, 128, 256, 1024};
+    unsigned long tick = (unsigned long)frameRate * rows;
+    uint8_t clockSelect = 0;
+    unsigned long counts = 0;
+    for (uint8_t i = 0; i < 7; i++) {
+        counts = F_CPU / ((unsigned long)pgm_read_word(&prescalers[i]) * tick);
+        if (counts >= 1 && counts <= 256) {
+            clockSelect = i + 1;
+            break;
+        }
+    }
+    if (!clockSelect)
+        return 0;
+
+    Scan_end();
+
+    cli();
+    scan_flags = flags;
+    scan_row_count = rows;
+    scan_rows_float = (dataCount == 0);
+    scan_data_port = dataPort;
+    scan_data_mask = dataMask;
+    scan_data_count = dataCount;
+    for (uint8_t i = 0; i < dataCount; i++)
+        scan_data_bits[i] = dataBits[i];
+    for (uint8_t i = 0; i < rows; i++) {
+        scan_rows[i].port = __ScanPort__(rowPins[i], &scan_rows[i].mask);
+        // Inactive level first, so no row lights up while it becomes an output
+        __ScanRelease__(&scan_rows[i]);
+        if (!scan_rows_float)
+            GPIOInit(rowPins[i], OUTPUT);
+    }
+    for (uint8_t i = 0; i < SCAN_MAX_ROWS; i++)
+        scan_buffers[0][i] = scan_buffers[1][i] = __ScanBlank__();
+    if (dataCount) {
+        _SFR_MEM8(dataPort) = (_SFR_MEM8(dataPort) & ~dataMask) | __ScanBlank__();
+        for (uint8_t i = 0; i < dataCount; i++)
+            GPIOInit(dataPins[i], OUTPUT);
+    }
+    scan_swap_pending = 0;
+    scan_row = rows - 1;
+
+    // CTC on OCR2A, this disconnects PWM on D3/D11
+    Power_enable(POWER_TIMER2);
+    TCCR2A = (1 << WGM21);
+    TCNT2 = 0;
+    OCR2A = counts - 1;
+    TIFR2 = (1 << OCF2A);
+    TIMSK2 |= (1 << OCIE2A);
+    TCCR2B = clockSelect;
+    // Rows advance in the Timer2 interrupt, so interrupts stay on from here
+    sei();
+
+    return 1;
+}
+
+// Read a key matrix on the same rows
+uint8_t Scan_keypad(const uint8_t *columnPins, uint8_t columns) {
+    uint8_t masks[8], columnMask;
+    if (columns == 0 || columns > 8 || !(scan_flags & SCAN_ROW_ACTIVE_LOW))
+        return 0;
+    uint8_t port = __ScanPinSet__(columnPins, columns, masks, &columnMask);
+    if (!port)
+        return 0;
+
+    uint8_t oldSREG = SREG;
+    cli();
+    for (uint8_t bit = 0; bit < 8; bit++)
+        scan_column_index[bit] = 0;
+    for (uint8_t i = 0; i < columns; i++) {
+        GPIOInit(columnPins[i], INPUT);
+        _SFR_MEM8(port) |= masks[i];   // Pull-up
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            if (masks[i] == (1 << bit))
+                scan_column_index[bit] = i;
+        }
+    }
+    for (uint8_t row = 0; row < SCAN_MAX_ROWS; row++)
+        scan_raw[row] = scan_last[row] = scan_stable[row] = 0;
+    scan_same_frames = 0;
+    scan_columns = columns;
+    scan_column_mask = columnMask;
+    scan_column_pin = port - 2;   // PINx is two below PORTx
+    SREG = oldSREG;
+
+    return 1;
+}
+
+// Stop the timer and release all rows
+void Scan_end() {
+    uint8_t oldSREG = SREG;
+    cli();
+    if (Power_enabled() & POWER_TIMER2) {
+        TIMSK2 &= ~(1 << OCIE2A);
+        TCCR2B = 0;
+    }
+    for (uint8_t i = 0; i < scan_row_count; i++)
+        __ScanRelease__(&scan_rows[i]);
+    if (scan_data_mask)
+        _SFR_MEM8(scan_data_port) = (_SFR_MEM8(scan_data_port) & ~scan_data_mask) | __ScanBlank__();
+    scan_row_count = 0;
+    scan_column_pin = 0;
+    SREG = oldSREG;
+}
+
+// Set a row of the back buffer, bit n of the pattern drives data pin n
+void Scan_write(uint8_t row, uint8_t pattern) {
+    if (row >= scan_row_count)
+        return;
+
+    uint8_t bits = 0;
+    for (uint8_t i = 0; i < scan_data_count; i++) {
+        if (pattern & (1 << i))
+            bits |= scan_data_bits[i];
+    }
+    if (scan_flags & SCAN_DATA_ACTIVE_LOW)
+        bits = ~bits & scan_data_mask;
+    scan_buffers[scan_front ^ 1][row] = bits;
+}
+
+// 7-segment pattern of a character
+uint8_t Scan_segments(char c) {
+    if (c >= '0' && c <= '9')
+        return pgm_read_byte(&scan_font[c - '0']);
+    if (c >= 'a' && c <= 'z')
+        c -= 'a' - 'A';
+    if (c >= 'A' && c <= 'Z')
+        return pgm_read_byte(&scan_font[c - 'A' + 10]);
+    if (c == '-')
+        return 0x40;
+    if (c == '_')
+        return 0x08;
+    return 0;
+}
+
+// Fill the back buffer with text for 7-segment digits
+void Scan_print(const char *text) {
+    uint8_t row = 0;
+    uint8_t previous = 0;
+    while (*text && row < scan_row_count) {
+        if (*text == '.') {
+            // Decimal point of the digit before, or a digit of its own
+            if (row > 0 && !(previous & SCAN_SEGMENT_DP)) {
+                previous |= SCAN_SEGMENT_DP;
+                Scan_write(row - 1, previous);
+            } else {
+                previous = SCAN_SEGMENT_DP;
+                Scan_write(row++, previous);
+            }
+        } else {
+            previous = Scan_segments(*text);
+            Scan_write(row++, previous);
+        }
+        text++;
+    }
+    while (row < scan_row_count)
+        Scan_write(row++, 0);
+}
+
+// Show the back buffer from the start of the next frame
+void Scan_swap() {
+    scan_swap_pending = 1;
+}
+
+// 1 once the last Scan_swap has taken effect
+uint8_t Scan_ready() {
+    return !scan_swap_pending;
+}
+
+// Take the next key event, returns 0 if there is none
+uint8_t Scan_readKey(uint8_t *event) {
+    return scan_events.pop(*event);
+}
+
+// Frames whose key readings were rejected because of ghosting
+unsigned long Scan_ghosts() {
+    uint8_t oldSREG = SREG;
+    cli();
+    unsigned long ghosts = scan_ghosts;
+    SREG = oldSREG;
+    return ghosts;
+}
+
+#endif
@@ -0,0 +1,289 @@
+#include "TWI.h"
+#include "Power.h"
+
+#if AVRLITE_USE_TWI
+
+// TWI status codes (TWSR with the prescaler bits masked)
+#define TW_START          0x08
+#define TW_REP_START      0x10
+#define TW_MT_SLA_ACK     0x18
+#define TW_MT_SLA_NACK    0x20
+#define TW_MT_DATA_ACK    0x28
+#define TW_MT_DATA_NACK   0x30
+#define TW_ARB_LOST       0x38
+#define TW_MR_SLA_ACK     0x40
+#define TW_MR_SLA_NACK    0x48
+#define TW_MR_DATA_ACK    0x50
+#define TW_MR_DATA_NACK   0x58
+
+// TWCR values for the next bus action
+#define TWCR_NEXT      ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+#define TWCR_ACK       (TWCR_NEXT | (1 << TWEA))
+#define TWCR_START     (TWCR_NEXT | (1 << TWSTA))
+#define TWCR_STOP      ((1 << TWINT) | (1 << TWEN) | (1 << TWSTO))
+#define TWCR_STOP_START (TWCR_NEXT | (1 << TWSTO) | (1 << TWSTA))
+
+// Transaction queue, twi_head is the one on the bus
+static TWI_Transaction *volatile twi_head;
+static TWI_Transaction *volatile twi_tail;
+static volatile uint8_t twi_index;
+static volatile uint8_t twi_reading;
+static volatile uint8_t twi_in_callback;
+// Bumped on every interrupt, TWI_update uses it to detect a stalled bus
+static volatile uint8_t twi_activity;
+static uint8_t twi_last_activity;
+static unsigned long twi_last_progress;
+static uint8_t twi_twbr, twi_twsr;
+
+// Finish the transaction on the bus and move on to the next one
+static void __TWIFinish__(uint8_t status) {
+    TWI_Transaction *t = twi_head;
+
+    twi_head = t->next;
+    if (twi_head == NULL)
+        twi_tail = NULL;
+    t->next = NULL;
+    t->status = status;
+
+    // The callback may queue follow-up transactions
+    twi_in_callback = 1;
+    if (t->callback)
+        t->callback(t);
+    twi_in_callback = 0;
+
+    TWI_Transaction *next = twi_head;
+    if (next != NULL) {
+        // STOP followed by START, the bus goes straight to the next transfer
+        next->status = TWI_BUSY;
+        twi_reading = (next->txLength == 0 && next->rxLength > 0);
+        TWCR = TWCR_STOP_START;
+    } else {
+        TWCR = TWCR_STOP;
+    }
+}
+
+// Interrupt Service Routine (ISR) for the TWI state machine
+ISR(TWI_vect) {
+    TWI_Transaction *t = twi_head;
+    twi_activity++;
+
+    if (t == NULL) {
+        TWCR = TWCR_STOP;
+        return;
+    }
+
+    switch (TWSR & 0xF8) {
+        case TW_START:
+        case TW_REP_START:
+            twi_index = 0;
+            TWDR = (t->address << 1) | (twi_reading ? 1 : 0);
+            TWCR = TWCR_NEXT;
+            break;
+
+        case TW_MT_SLA_ACK:
+        case TW_MT_DATA_ACK:
+            if (twi_index < t->txLength) {
+                TWDR = t->txData[twi_index++];
+                TWCR = TWCR_NEXT;
+            } else if (t->rxLength) {
+                // Repeated START for the read phase
+                twi_reading = 1;
+                TWCR = TWCR_START;
+            } else {
+                __TWIFinish__(TWI_DONE);
+            }
+            break;
+
+        case TW_MR_SLA_ACK:
+            // ACK every byte but the last one
+            TWCR = (t->rxLength > 1) ? TWCR_ACK : TWCR_NEXT;
+            break;
+
+        case TW_MR_DATA_ACK:
+            t->rxData[twi_index++] = TWDR;
+            TWCR = (twi_index < t->rxLength - 1) ? TWCR_ACK : TWCR_NEXT;
+            break;
+
+        case TW_MR_DATA_NACK:
+            t->rxData[twi_index++] = TWDR;
+            __TWIFinish__(TWI_DONE);
+            break;
+
+        case TW_MT_SLA_NACK:
+        case TW_MT_DATA_NACK:
+        case TW_MR_SLA_NACK:
+            __TWIFinish__(TWI_NACK);
+            break;
+
+        case TW_ARB_LOST:
+        default:
+            __TWIFinish__(TWI_ERROR);
+            break;
+    }
+}
+
+// Initialize the TWI master at the given bus frequency, returns 0 if it is not reachable
+int TWI_begin(unsigned long frequency) {
+    // SCL = F_CPU / (16 + 2 * TWBR * 4^prescaler)
+    if (frequency == 0 || frequency > F_CPU / 16)
+        return 0;
+
+    unsigned long twbr = (F_CPU / frequency - 16) / 2;
+    uint8_t prescaler = 0;
+    while (twbr > 255 && prescaler < 3) {
+        twbr /= 4;
+        prescaler++;
+    }
+    if (twbr > 255)
+        return 0;
+
+    twi_twbr = twbr;
+    twi_twsr = prescaler;
+
+    // Internal pull-ups on SDA (A4) and SCL (A5)
+    GPIOInit(A4, INPUT);
+    GPIOInit(A5, INPUT);
+    GPIOWrite(A4, HIGH);
+    GPIOWrite(A5, HIGH);
+
+    Power_enable(POWER_TWI);
+    TWSR = twi_twsr;
+    TWBR = twi_twbr;
+    TWCR = (1 << TWEN);
+    // Transactions advance in TWI_vect
+    sei();
+
+    return 1;
+}
+
+// Queue a transaction, returns 0 if it is still queued from an earlier submit
+int TWI_submit(TWI_Transaction *t) {
+    if (t->status == TWI_PENDING || t->status == TWI_BUSY)
+        return 0;
+
+    uint8_t oldSREG = SREG;
+    cli();
+
+    t->next = NULL;
+    t->status = TWI_PENDING;
+    if (twi_tail != NULL) {
+        twi_tail->next = t;
+        twi_tail = t;
+    } else {
+        twi_head = twi_tail = t;
+        // Inside a completion callback __TWIFinish__ starts it
+        if (!twi_in_callback) {
+            // Bus idle, start right away
+            t->status = TWI_BUSY;
+            twi_reading = (t->txLength == 0 && t->rxLength > 0);
+            twi_activity++;
+            TWCR = TWCR_START;
+        }
+    }
+
+    SREG = oldSREG;
+    return 1;
+}
+
+// Fill in and queue a write transaction
+int TWI_write(TWI_Transaction *t, uint8_t address, const uint8_t *data, uint8_t length, TWI_Callback callback) {
+    return TWI_writeRead(t, address, data, length, NULL, 0, callback);
+}
+
+// Fill in and queue a read transaction
+int TWI_read(TWI_Transaction *t, uint8_t address, uint8_t *data, uint8_t length, TWI_Callback callback) {
+    return TWI_writeRead(t, address, NULL, 0, data, length, callback);
+}
+
+// Fill in and queue a write-then-read transaction
+int TWI_writeRead(TWI_Transaction *t, uint8_t address, const uint8_t *txData, uint8_t txLength,
+                  uint8_t *rxData, uint8_t rxLength, TWI_Callback callback) {
+    if (t->status == TWI_PENDING || t->status == TWI_BUSY)
+        return 0;
+
+    t->address = address;
+    t->txData = txData;
+    t->txLength = txLength;
+    t->rxData = rxData;
+    t->rxLength = rxLength;
+    t->callback = callback;
+    return TWI_submit(t);
+}
+
+// Return 1 while transactions are queued or on the bus
+uint8_t TWI_busy() {
+    return twi_head != NULL;
+}
+
+// Check the running transaction for a timeout, call regularly from the main loop
+void TWI_update() {
+    if (twi_head == NULL)
+        return;
+
+    unsigned long now = uptimeMs();
+    uint8_t activity = twi_activity;
+    if (activity != twi_last_activity) {
+        twi_last_activity = activity;
+        twi_last_progress = now;
+    } else if (now - twi_last_progress > TWI_TIMEOUT_MS) {
+        TWI_recover();
+    }
+}
+
+// Wait for a transaction to finish and return its final status
+uint8_t TWI_wait(TWI_Transaction *t) {
+    while (t->status == TWI_PENDING || t->status == TWI_BUSY)
+        TWI_update();
+    return t->status;
+}
+
+// Abort everything and free a stuck bus by clocking SCL and sending a STOP
+void TWI_recover() {
+    uint8_t oldSREG = SREG;
+    cli();
+
+    // Hand the pins back to GPIO
+    TWCR = 0;
+
+    // Up to 9 clocks until the slave releases SDA
+    GPIOInit(A4, INPUT);
+    GPIOWrite(A4, HIGH);
+    for (uint8_t i = 0; i < 9 && GPIORead(A4, DIGITALREAD) == LOW; i++) {
+        GPIOWrite(A5, LOW);
+        GPIOInit(A5, OUTPUT);
+        _delay_us(5);
+        GPIOInit(A5, INPUT);
+        GPIOWrite(A5, HIGH);
+        _delay_us(5);
+    }
+
+    // STOP: SDA rises while SCL is high
+    GPIOWrite(A4, LOW);
+    GPIOInit(A4, OUTPUT);
+    _delay_us(5);
+    GPIOInit(A4, INPUT);
+    GPIOWrite(A4, HIGH);
+    _delay_us(5);
+
+    // TWI back on before the callbacks, a retry submitted from one starts on the bus right away
+    Power_enable(POWER_TWI);
+    TWSR = twi_twsr;
+    TWBR = twi_twbr;
+    TWCR = (1 << TWEN);
+
+    // Fail everything that was queued
+    TWI_Transaction *t = twi_head;
+    twi_head = twi_tail = NULL;
+    while (t != NULL) {
+        TWI_Transaction *next = t->next;
+        t->next = NULL;
+        t->status = TWI_TIMEOUT;
+        if (t->callback)
+            t->callback(t);
+        t = next;
+    }
+
+    SREG = oldSREG;
+}
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef TWI_h
+#define TWI_h
+
+#include "AVRLite.h"
+
+// Time without bus progress before a transaction is aborted, in milliseconds
+#ifndef TWI_TIMEOUT_MS
+#define TWI_TIMEOUT_MS 10
+#endif
+
+// Common bus speeds for TWI_begin
+#define TWI_STANDARD  100000UL
+#define TWI_FAST      400000UL
+#define TWI_FAST_PLUS 1000000UL
+
+// Transaction status
+#define TWI_IDLE    0x0  // Never submitted
+#define TWI_PENDING 0x1  // Queued, not started yet
+#define TWI_BUSY    0x2  // On the bus
+#define TWI_DONE    0x3  // Completed successfully
+#define TWI_NACK    0x4  // Address or data not acknowledged
+#define TWI_ERROR   0x5  // Bus error or arbitration lost
+#define TWI_TIMEOUT 0x6  // No progress for TWI_TIMEOUT_MS, bus recovered
+
+struct TWI_Transaction;
+// Completion callback, runs inside the TWI interrupt so keep it short
+typedef void (*TWI_Callback)(struct TWI_Transaction *t);
+
+// A queued transfer: writes txLength bytes, then reads rxLength bytes after a repeated START
+typedef struct TWI_Transaction {
+    uint8_t address;            // 7-bit slave address
+    const uint8_t *txData;
+    uint8_t txLength;
+    uint8_t *rxData;
+    uint8_t rxLength;
+    TWI_Callback callback;      // Optional, may be NULL
+    volatile uint8_t status;
+    struct TWI_Transaction *next;
+} TWI_Transaction;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Initialize the TWI master at the given bus frequency, returns 0 if it is not reachable
+int TWI_begin(unsigned long frequency);
+
+// Queue a transaction, returns 0 if it is still queued from an earlier submit
+int TWI_submit(TWI_Transaction *t);
+// Fill in and queue a write, a read or a write-then-read transaction
+int TWI_write(TWI_Transaction *t, uint8_t address, const uint8_t *data, uint8_t length, TWI_Callback callback = NULL);
+int TWI_read(TWI_Transaction *t, uint8_t address, uint8_t *data, uint8_t length, TWI_Callback callback = NULL);
+int TWI_writeRead(TWI_Transaction *t, uint8_t address, const uint8_t *txData, uint8_t txLength,
+                  uint8_t *rxData, uint8_t rxLength, TWI_Callback callback = NULL);
+
+// Return 1 while transactions are queued or on the bus
+uint8_t TWI_busy();
+// Check the running transaction for a timeout, call regularly from the main loop
+void TWI_update();
+// Wait for a transaction to finish and return its final status
+uint8_t TWI_wait(TWI_Transaction *t);
+// Abort everything and free a stuck bus by clocking SCL and sending a STOP
+void TWI_recover();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
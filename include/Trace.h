@@ -0,0 +1,73 @@
+#ifndef Trace_h
+#define Trace_h
+
+#include "AVRLite.h"
+
+/**
+ * Post-mortem trace of pin activity: GPIOInit, GPIOWrite (digital and PWM) and analog reads
+ * append a 5-byte record (event, pin, value, microseconds since the previous record) to a
+ * circular RAM buffer that keeps the newest records. Build with -DAVRLITE_TRACE to enable it;
+ * otherwise every macro below expands to nothing. tools/trace2vcd turns a dump into a VCD file.
+ */
+
+// Number of records kept (power of two, at most 128), 5 bytes each
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 32
+#endif
+
+// Record kinds, stored in the upper 3 bits of the record tag (pin or id in the lower 5)
+#define TRACE_WRITE 0x0  // Digital write, value LOW/HIGH
+#define TRACE_MODE  0x1  // GPIOInit, value 1 for OUTPUT, 0 for INPUT
+#define TRACE_PWM   0x2  // PWM duty cycle 0..255
+#define TRACE_ADC   0x3  // Analog read result 0..1023
+#define TRACE_MARK  0x4  // Application marker, id 0..31 and a 16-bit value
+#define TRACE_TIME  0x7  // Gap over 65535 us: value holds the upper 16 bits of the delta
+
+// Dump format: "AVTR", version, record count, base time (us, little endian), then the records
+#define TRACE_DUMP_VERSION 1
+
+// One trace record
+typedef struct {
+    uint8_t tag;     // (kind << 5) | pin
+    uint16_t value;
+    uint16_t delta;  // Microseconds since the previous record
+} Trace_Record;
+
+#ifdef AVRLITE_TRACE
+
+#if TRACE_BUFFER_SIZE > 128 || (TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1))
+#error "TRACE_BUFFER_SIZE must be a power of two up to 128"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Append a record (used by the GPIO functions and TRACE_MARK)
+void Trace_record(uint8_t kind, uint8_t pin, uint16_t value);
+// Freeze `after` records after one matching kind, pin and value, like a logic analyzer trigger
+void Trace_trigger(uint8_t kind, uint8_t pin, uint16_t value, uint8_t after);
+// Stop capturing now
+void Trace_freeze();
+// Capture again, disarms the trigger
+void Trace_resume();
+// 1 once the trace is frozen
+uint8_t Trace_frozen();
+// Number of records in the buffer
+uint8_t Trace_count();
+// Drop all records
+void Trace_clear();
+// Send the buffer over Serial in binary, oldest record first
+void Trace_dump();
+#ifdef __cplusplus
+}
+#endif
+
+#define TRACE_RECORD(kind, pin, value) Trace_record((kind), (pin), (value))
+
+#else
+
+#define TRACE_RECORD(kind, pin, value)
+
+#endif
+
+#endif
@@ -0,0 +1,134 @@
+#include "WS2812.h"
+
+#if AVRLITE_USE_WS2812
+
+// Cycle padding between the edges of a bit. With `st` taking 2 cycles:
+//   high time of a 0 bit = PAD0 + 3, high time of a 1 bit = PAD0 + PAD1 + 5,
+//   bit period = PAD0 + PAD1 + PAD2 + 10 (11 for a 0 bit).
+// Targets: T0H ~0.35-0.4 us, T1H ~0.75-0.8 us, period >= 1.25 us.
+#define WS2812_NOP1 "nop\n\t"
+#define WS2812_NOP2 "rjmp .+0\n\t"
+
+#if F_CPU == 8000000UL
+// T0H 3 (375 ns), T1H 6 (750 ns), period 11
+#define WS2812_PAD0 ""
+#define WS2812_PAD1 WS2812_NOP1
+#define WS2812_PAD2 ""
+#elif F_CPU == 16000000UL
+// T0H 6 (375 ns), T1H 13 (813 ns), period 19-20
+#define WS2812_PAD0 WS2812_NOP2 WS2812_NOP1
+#define WS2812_PAD1 WS2812_NOP2 WS2812_NOP2 WS2812_NOP1
+#define WS2812_PAD2 WS2812_NOP1
+#elif F_CPU == 20000000UL
+// T0H 7 (350 ns), T1H 16 (800 ns), period 25-26
+#define WS2812_PAD0 WS2812_NOP2 WS2812_NOP2
+#define WS2812_PAD1 WS2812_NOP2 WS2812_NOP2 WS2812_NOP2 WS2812_NOP1
+#define WS2812_PAD2 WS2812_NOP2 WS2812_NOP2
+#else
+#error "WS2812 timing is only defined for F_CPU of 8, 16 or 20 MHz"
+#endif
+
+// Load byte `offset` of the pixel, scale it by (brightness + 1) / 256 and send its 8 bits.
+// Loading and scaling happen in the low phase after the previous bit, which the strip tolerates.
+#define WS2812_BYTE(offset, label)              \
+    "ldd  %[b], Z+" offset "\n\t"               \
+    "mul  %[b], %[scale]\n\t"                   \
+    "add  r0, %[b]\n\t"                         \
+    "adc  r1, %[zero]\n\t"                      \
+    "mov  %[b], r1\n\t"                         \
+    "ldi  %[n], 8\n\t"                          \
+    label ":\n\t"                               \
+    "st   X, %[hi]\n\t"                         \
+    WS2812_PAD0                                 \
+    "sbrs %[b], 7\n\t"                          \
+    "st   X, %[lo]\n\t"                         \
+    "lsl  %[b]\n\t"                             \
+    WS2812_PAD1                                 \
+    "st   X, %[lo]\n\t"                         \
+    WS2812_PAD2                                 \
+    "dec  %[n]\n\t"                             \
+    "brne " label "b\n\t"
+
+// Send `count` pixels, interrupts must be disabled by the caller
+static inline __attribute__((always_inline))
+void __WS2812Send__(volatile uint8_t *port, uint8_t hi, uint8_t lo, const uint8_t *pixels,
+                    uint16_t count, uint8_t order, uint8_t scale) {
+    uint8_t b, n;
+
+    if (order == WS2812_RGB) {
+        asm volatile(
+            "4:\n\t"
+            WS2812_BYTE("1", "1")
+            WS2812_BYTE("0", "2")
+            WS2812_BYTE("2", "3")
+            "adiw %[ptr], 3\n\t"
+            "sbiw %[count], 1\n\t"
+            "brne 4b\n\t"
+            "clr  __zero_reg__\n\t"
+            : [b] "=&r" (b), [n] "=&d" (n), [ptr] "+z" (pixels), [count] "+w" (count)
+            : [port] "x" (port), [hi] "r" (hi), [lo] "r" (lo), [scale] "r" (scale), [zero] "r" ((uint8_t)0)
+            : "r0", "memory"
+        );
+    } else {
+        asm volatile(
+            "4:\n\t"
+            WS2812_BYTE("0", "1")
+            WS2812_BYTE("1", "2")
+            WS2812_BYTE("2", "3")
+            "adiw %[ptr], 3\n\t"
+            "sbiw %[count], 1\n\t"
+            "brne 4b\n\t"
+            "clr  __zero_reg__\n\t"
+            : [b] "=&r" (b), [n] "=&d" (n), [ptr] "+z" (pixels), [count] "+w" (count)
+            : [port] "x" (port), [hi] "r" (hi), [lo] "r" (lo), [scale] "r" (scale), [zero] "r" ((uint8_t)0)
+            : "r0", "memory"
+        );
+    }
+}
+
+// End of the last frame, for the latch delay
+static unsigned long ws2812_last_frame;
+
+// Configure the data pin as a LOW output
+void WS2812_begin(uint8_t pin) {
+    GPIOWrite(pin, LOW);
+    GPIOInit(pin, OUTPUT);
+    ws2812_last_frame = uptimeUs();
+}
+
+// Send `count` pixels and scale every byte by brightness (255 = unchanged) in the same pass
+void WS2812_show(uint8_t pin, const uint8_t *pixels, uint16_t count, uint8_t order, uint8_t brightness) {
+    volatile uint8_t *port;
+    uint8_t mask;
+
+    if (pin <= 7)                      { port = &PORTD; mask = 1 << pin; }
+    else if (pin >= 8 && pin <= 13)    { port = &PORTB; mask = 1 << (pin - 8); }
+    else if (pin >= 14 && pin <= 19)   { port = &PORTC; mask = 1 << (pin - 14); }
+    else return;
+
+    if (count == 0)
+        return;
+
+    // Let the previous frame latch
+    while (uptimeUs() - ws2812_last_frame < WS2812_RESET_US);
+
+    uint8_t oldSREG = SREG;
+#if WS2812_PIXEL_CRITICAL
+    // Interrupts only stay off for one pixel (24 bits) at a time
+    for (; count > 0; count--, pixels += 3) {
+        cli();
+        uint8_t hi = *port | mask, lo = *port & ~mask;
+        __WS2812Send__(port, hi, lo, pixels, 1, order, brightness);
+        SREG = oldSREG;
+    }
+#else
+    cli();
+    uint8_t hi = *port | mask, lo = *port & ~mask;
+    __WS2812Send__(port, hi, lo, pixels, count, order, brightness);
+    SREG = oldSREG;
+#endif
+
+    ws2812_last_frame = uptimeUs();
+}
+
+#endif
@@ -0,0 +1,154 @@
+#include "Work.h"
+#include "RingBuffer.h"
+
+#if AVRLITE_USE_WORK
+
+static_assert(WORK_PRIORITIES >= 1 && WORK_PRIORITIES <= 4, "WORK_PRIORITIES must be 1 to 4");
+
+// A pending handler and when it was posted, in Timer0 ticks (64 cycles)
+typedef struct {
+    Work_Handler handler;
+    uint16_t arg;
+    uint16_t posted;
+} WorkItem;
+
+// One queue per priority: posts are the producer (with interrupts off), Work_run the consumer
+static RingBuffer<WorkItem, WORK_QUEUE_SIZE> work_queues[WORK_PRIORITIES];
+
+// Producer counters, only changed with interrupts off
+static unsigned long work_posted;
+static unsigned int work_coalesced;
+static unsigned int work_dropped;
+static uint8_t work_max_depth;
+
+// Consumer counters
+static unsigned long work_run_count;
+static unsigned long work_wait_total;
+static uint16_t work_wait_max;
+static uint8_t work_running;
+
+extern volatile unsigned long timer0_overflow_count;
+
+// Low 16 bits of the Timer0 tick count behind uptimeUs, call with interrupts off
+static inline uint16_t __WorkStamp__() {
+    uint8_t wraps = (uint8_t)timer0_overflow_count;
+    uint8_t ticks = TCNT0;
+    if ((TIFR0 & (1 << TOV0)) && ticks < 255)
+        wraps++;
+    return ((uint16_t)wraps << 8) | ticks;
+}
+
+// Timer0 ticks to microseconds
+static inline unsigned long __WorkMicros__(unsigned long ticks) {
+    return ticks * 64UL / (F_CPU / 1000000UL);
+}
+
+// Queue a handler, returns 1 if it is pending, 0 if the queue was full. Bounded: about 60 cycles,
+// plus about 12 per pending item compared with WORK_COALESCE.
+uint8_t Work_post(Work_Handler handler, uint16_t arg, uint8_t priority) {
+    uint8_t level = priority & ~WORK_COALESCE;
+    if (level >= WORK_PRIORITIES)
+        level = WORK_PRIORITIES - 1;
+    RingBuffer<WorkItem, WORK_QUEUE_SIZE> &queue = work_queues[level];
+
+    uint8_t oldSREG = SREG;
+    cli();
+
+    // An item the consumer is still copying counts as pending, its handler has not started yet
+    if (priority & WORK_COALESCE) {
+        WorkItem *pending;
+        for (uint8_t i = 0; (pending = queue.at(i)) != NULL; i++) {
+            if (pending->handler == handler && pending->arg == arg) {
+                work_coalesced++;
+                SREG = oldSREG;
+                return 1;
+            }
+        }
+    }
+
+    WorkItem item = {handler, arg, __WorkStamp__()};
+    uint8_t result = queue.push(item);
+    if (result) {
+        work_posted++;
+        if (queue.size() > work_max_depth)
+            work_max_depth = queue.size();
+    } else {
+        work_dropped++;
+    }
+
+    SREG = oldSREG;
+    return result;
+}
+
+// Run up to budget pending items, highest priority first, returns how many ran
+uint8_t Work_run(uint8_t budget) {
+    if (work_running)
+        return 0;
+    __TimeBegin__();
+    work_running = 1;
+
+    uint8_t done = 0;
+    while (done < budget) {
+        // Look from the top again after every item, a post meanwhile may outrank the rest
+        WorkItem item;
+        uint8_t level = 0;
+        while (level < WORK_PRIORITIES && !work_queues[level].pop(item))
+            level++;
+        if (level == WORK_PRIORITIES)
+            break;
+
+        uint8_t oldSREG = SREG;
+        cli();
+        uint16_t wait = __WorkStamp__() - item.posted;
+        SREG = oldSREG;
+        work_wait_total += wait;
+        if (wait > work_wait_max)
+            work_wait_max = wait;
+        work_run_count++;
+
+        item.handler(item.arg);
+        done++;
+    }
+
+    work_running = 0;
+    return done;
+}
+
+// Items waiting at all priorities
+uint8_t Work_pending() {
+    uint8_t pending = 0;
+    for (uint8_t level = 0; level < WORK_PRIORITIES; level++)
+        pending += work_queues[level].size();
+    return pending;
+}
+
+// Copy the counters
+void Work_stats(Work_Stats *stats) {
+    uint8_t oldSREG = SREG;
+    cli();
+    stats->posted = work_posted;
+    stats->coalesced = work_coalesced;
+    stats->dropped = work_dropped;
+    stats->maxDepth = work_max_depth;
+    SREG = oldSREG;
+
+    stats->run = work_run_count;
+    stats->maxWaitUs = __WorkMicros__(work_wait_max);
+    stats->meanWaitUs = work_run_count ? __WorkMicros__(work_wait_total / work_run_count) : 0;
+}
+
+// Clear the counters
+void Work_resetStats() {
+    uint8_t oldSREG = SREG;
+    cli();
+    work_posted = 0;
+    work_coalesced = work_dropped = 0;
+    work_max_depth = 0;
+    SREG = oldSREG;
+
+    work_run_count = 0;
+    work_wait_total = 0;
+    work_wait_max = 0;
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef Work_h
+#define Work_h
+
+#include "AVRLite.h"
+
+// Priority levels, 0 runs first (at most 4)
+#ifndef WORK_PRIORITIES
+#define WORK_PRIORITIES 3
+#endif
+
+// Pending items per priority (power of two, at most 128)
+#ifndef WORK_QUEUE_SIZE
+#define WORK_QUEUE_SIZE 8
+#endif
+
+// Items sleep() runs before it idles again
+#ifndef WORK_BATCH
+#define WORK_BATCH 4
+#endif
+
+// Priorities for Work_post
+#define WORK_HIGH   0
+#define WORK_NORMAL 1
+#define WORK_LOW    2
+
+// Work_post option: drop the post if the same handler and argument are already pending
+#define WORK_COALESCE 0x80
+
+// Deferred handler, runs in the main loop with the argument given to Work_post
+typedef void (*Work_Handler)(uint16_t arg);
+
+// Counters since the last Work_resetStats
+typedef struct {
+    unsigned long posted;      // Items queued
+    unsigned long run;         // Items executed
+    unsigned int coalesced;    // Posts merged into an identical pending item
+    unsigned int dropped;      // Posts lost because their priority's queue was full
+    uint8_t maxDepth;          // Most items pending at one priority
+    unsigned long maxWaitUs;   // Longest time from post to handler start (waits over 262 ms alias)
+    unsigned long meanWaitUs;  // Average time from post to handler start
+} Work_Stats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Queue a handler, e.g. from an ISR (WORK_HIGH, WORK_NORMAL or WORK_LOW, plus WORK_COALESCE).
+// Returns 1 if it is pending, 0 if the queue was full.
+uint8_t Work_post(Work_Handler handler, uint16_t arg, uint8_t priority);
+
+// Run up to budget pending items, highest priority first, returns how many ran. Called by sleep()
+// as well; a handler calling it (or sleep) does not run further items.
+uint8_t Work_run(uint8_t budget);
+
+// Items waiting at all priorities
+uint8_t Work_pending();
+
+// Copy the counters
+void Work_stats(Work_Stats *stats);
+// Clear the counters
+void Work_resetStats();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,325 @@
+/**
+ * @file avrlite_upload.cpp
+ * @brief Host-side uploader for the AVRLite bootloader (bootloader/bootloader.cpp)
+ * Resets the board through DTR, programs an Intel HEX image page by page and checks the
+ * CRC-16 of the whole written range before starting the application.
+ *
+ * @details
+ * - Build on Linux: g++ -O2 -o avrlite_upload tools/avrlite_upload.cpp
+ * - Upload:         ./avrlite_upload /dev/ttyUSB0 firmware/main_out.hex [baud]
+ * - Options:        --no-reset (board already in the bootloader), --raw (no run-length coding)
+ * - Pages are run-length coded, pages already in flash are skipped by the bootloader, so
+ *   uploading the same image again only costs the transfer.
+ * - Prints the pages written and skipped, the bytes sent and the total time.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+
+// Must match bootloader.cpp
+#define PAGE_SIZE     128
+#define BOOT_START    0x7E00
+#define BOOT_VERSION  1
+
+static uint8_t image[BOOT_START];
+static int image_size;
+
+// Same polynomial as _crc_ccitt_update() in avr-libc <util/crc16.h>
+static uint16_t crc_ccitt_update(uint16_t crc, uint8_t data) {
+    data ^= (uint8_t)(crc & 0xFF);
+    data ^= data << 4;
+    return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+}
+
+static int hex_byte(const char *s) {
+    int value;
+    return sscanf(s, "%2x", &value) == 1 ? value : -1;
+}
+
+// Load an Intel HEX file into `image`, unused bytes stay 0xFF (erased flash)
+static int load_hex(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        perror(path);
+        return -1;
+    }
+
+    memset(image, 0xFF, sizeof(image));
+    char line[600];
+    uint32_t base = 0;
+    int number = 0;
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        if (line[0] != ':')
+            continue;
+
+        int count = hex_byte(line + 1);
+        int address = hex_byte(line + 3) << 8 | hex_byte(line + 5);
+        int type = hex_byte(line + 7);
+        uint8_t sum = count + (address >> 8) + address + type;
+        uint8_t data[256];
+        for (int i = 0; i <= count; i++) {
+            int value = hex_byte(line + 9 + 2 * i);
+            if (value < 0) {
+                fprintf(stderr, "%s:%d: malformed record\n", path, number);
+                fclose(file);
+                return -1;
+            }
+            sum += value;
+            if (i < count)
+                data[i] = value;
+        }
+        if (sum != 0) {
+            fprintf(stderr, "%s:%d: checksum error\n", path, number);
+            fclose(file);
+            return -1;
+        }
+
+        if (type == 0x00) {
+            uint32_t start = base + address;
+            if (start + count > BOOT_START) {
+                fprintf(stderr, "%s:%d: data at 0x%04X overlaps the bootloader\n", path, number, start);
+                fclose(file);
+                return -1;
+            }
+            memcpy(image + start, data, count);
+            if ((int)(start + count) > image_size)
+                image_size = start + count;
+        } else if (type == 0x01) {
+            break;
+        } else if (type == 0x02) {
+            base = (data[0] << 8 | data[1]) << 4;
+        } else if (type == 0x04) {
+            base = (uint32_t)(data[0] << 8 | data[1]) << 16;
+        }
+    }
+    fclose(file);
+    return image_size;
+}
+
+// Run-length code one page, returns the encoded length
+static int encode_page(const uint8_t *page, uint8_t *out, int raw) {
+    int length = 0, i = 0;
+    if (raw) {
+        out[length++] = PAGE_SIZE - 1;
+        memcpy(out + length, page, PAGE_SIZE);
+        return length + PAGE_SIZE;
+    }
+
+    while (i < PAGE_SIZE) {
+        int run = 1;
+        while (i + run < PAGE_SIZE && run < 129 && page[i + run] == page[i])
+            run++;
+        if (run >= 3) {
+            out[length++] = 0x7E + run;
+            out[length++] = page[i];
+            i += run;
+            continue;
+        }
+
+        // Literals up to the next run of three
+        int start = i;
+        while (i < PAGE_SIZE && i - start < 128) {
+            if (i + 2 < PAGE_SIZE && page[i] == page[i + 1] && page[i] == page[i + 2])
+                break;
+            i++;
+        }
+        out[length++] = i - start - 1;
+        memcpy(out + length, page + start, i - start);
+        length += i - start;
+    }
+    return length;
+}
+
+static speed_t baud_constant(long baud) {
+    switch (baud) {
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 500000:  return B500000;
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+    }
+    return 0;
+}
+
+static int open_port(const char *path, long baud) {
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    struct termios tty;
+    tcgetattr(fd, &tty);
+    cfmakeraw(&tty);
+    speed_t speed = baud_constant(baud);
+    if (speed == 0) {
+        fprintf(stderr, "unsupported baud rate %ld\n", baud);
+        close(fd);
+        return -1;
+    }
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tty);
+
+    // USB adapters batch replies for up to 16 ms by default, one page is about 1.3 ms
+    struct serial_struct serial;
+    if (ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        ioctl(fd, TIOCSSERIAL, &serial);
+    }
+    return fd;
+}
+
+// Pulse DTR/RTS, the auto-reset capacitor turns the edge into an external reset
+static void reset_board(int fd) {
+    int lines = TIOCM_DTR | TIOCM_RTS;
+    ioctl(fd, TIOCMBIC, &lines);
+    usleep(50000);
+    ioctl(fd, TIOCMBIS, &lines);
+    usleep(50000);
+    tcflush(fd, TCIOFLUSH);
+}
+
+// Read exactly `length` bytes, returns 0 on timeout
+static int read_exact(int fd, uint8_t *data, int length, int timeout_ms) {
+    int done = 0;
+    while (done < length) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, timeout_ms) <= 0)
+            return 0;
+        ssize_t n = read(fd, data + done, length - done);
+        if (n <= 0)
+            return 0;
+        done += n;
+    }
+    return 1;
+}
+
+static int write_all(int fd, const uint8_t *data, int length) {
+    while (length > 0) {
+        ssize_t n = write(fd, data, length);
+        if (n <= 0)
+            return 0;
+        data += n;
+        length -= n;
+    }
+    return 1;
+}
+
+static double now_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+    const char *port = NULL, *hex = NULL;
+    long baud = 1000000;
+    int reset = 1, raw = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--no-reset") == 0)
+            reset = 0;
+        else if (strcmp(argv[i], "--raw") == 0)
+            raw = 1;
+        else if (!port)
+            port = argv[i];
+        else if (!hex)
+            hex = argv[i];
+        else
+            baud = atol(argv[i]);
+    }
+    if (!port || !hex) {
+        fprintf(stderr, "usage: %s [--no-reset] [--raw] <serial-port> <image.hex> [baud]\n", argv[0]);
+        return 1;
+    }
+
+    if (load_hex(hex) < 0)
+        return 1;
+    int fd = open_port(port, baud);
+    if (fd < 0)
+        return 1;
+
+    double start = now_seconds();
+    if (reset)
+        reset_board(fd);
+
+    // Sync, the bootloader may still be starting up
+    uint8_t reply[3];
+    int synced = 0;
+    for (int attempt = 0; attempt < 20 && !synced; attempt++) {
+        uint8_t sync = 'S';
+        write_all(fd, &sync, 1);
+        synced = read_exact(fd, reply, 3, 50) && reply[0] == 'A' && reply[1] == 'L';
+        if (!synced)
+            tcflush(fd, TCIFLUSH);
+    }
+    if (!synced) {
+        fprintf(stderr, "no response from the bootloader on %s\n", port);
+        return 1;
+    }
+    if (reply[2] != BOOT_VERSION)
+        fprintf(stderr, "bootloader version %u, expected %u\n", reply[2], BOOT_VERSION);
+
+    int pages = (image_size + PAGE_SIZE - 1) / PAGE_SIZE;
+    int written = 0, skipped = 0;
+    long sent = 0;
+    for (int page = 0; page < pages; page++) {
+        uint8_t packet[2 + PAGE_SIZE + PAGE_SIZE / 64 + 1];
+        packet[0] = 'P';
+        packet[1] = page;
+        int length = 2 + encode_page(image + page * PAGE_SIZE, packet + 2, raw);
+        // Erase and write take about 9 ms, the reply comes once the write has started
+        uint8_t status = 0;
+        if (!write_all(fd, packet, length) || !read_exact(fd, &status, 1, 500) || (status != '+' && status != '=')) {
+            if (status == '!')
+                fprintf(stderr, "page %d: refused, inside the boot section\n", page);
+            else
+                fprintf(stderr, "page %d: no acknowledge\n", page);
+            return 1;
+        }
+        sent += length;
+        if (status == '+')
+            written++;
+        else
+            skipped++;
+    }
+
+    // CRC of every page programmed, compared with the image
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < pages * PAGE_SIZE; i++)
+        crc = crc_ccitt_update(crc, image[i]);
+    uint8_t command[2] = {'C', (uint8_t)pages};
+    uint8_t device[2];
+    if (!write_all(fd, command, 2) || !read_exact(fd, device, 2, 1000)) {
+        fprintf(stderr, "no CRC from the bootloader\n");
+        return 1;
+    }
+    if ((device[0] | device[1] << 8) != crc) {
+        fprintf(stderr, "verify failed: CRC 0x%04X, expected 0x%04X\n", device[0] | device[1] << 8, crc);
+        return 1;
+    }
+
+    uint8_t go = 'G';
+    write_all(fd, &go, 1);
+    read_exact(fd, reply, 1, 100);
+    close(fd);
+
+    double elapsed = now_seconds() - start;
+    printf("%d bytes, %d pages: %d written, %d unchanged\n", image_size, pages, written, skipped);
+    printf("%ld bytes sent (%.0f%% of the image), CRC 0x%04X verified\n", sent, 100.0 * sent / (pages * PAGE_SIZE), crc);
+    printf("%.2f s at %ld baud\n", elapsed, baud);
+    return 0;
+}
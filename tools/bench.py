@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""
+AVRLite benchmark runner, used by the avrlite_bench CMake target.
+
+Runs bench/bench.cpp under simavr, collects cycles per call, timer ISR cost and interrupt
+latency, SPI and encoder throughput and EEPROM stall and wear figures, adds the flash/RAM footprint of every library module (avr-size on libavrlite.a),
+writes everything as JSON and fails when a value grew past the allowed tolerance against
+a baseline file (a previous results file).
+
+  bench.py --simavr run_avr --elf avrlite_bench --library libavrlite.a \
+           --output avrlite_bench.json [--baseline baseline.json] [--tolerance 5]
+"""
+
+import argparse
+import json
+import re
+import subprocess
+import sys
+
+BENCH_RE = re.compile(r"BENCH (\S+) (\d+) (\d+)")
+ISR_RE = re.compile(r"ISR (\S+) (\d+) (\d+) (\d+) (\d+)")
+LATENCY_RE = re.compile(r"LATENCY (\d+) (\d+)")
+THROUGHPUT_RE = re.compile(r"THROUGHPUT (\S+) (\d+) (\d+) (\d+)")
+STAT_RE = re.compile(r"STAT (\S+) (\d+)")
+
+
+def run_firmware(simavr, elf, mcu, frequency, timeout):
+    result = subprocess.run([simavr, "-m", mcu, "-f", str(frequency), elf],
+                            stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True, errors="replace", timeout=timeout)
+    # simavr colors the UART output, drop the escape sequences (telemetry frames are binary)
+    return re.sub(r"\x1b\[[0-9;]*m", "", result.stdout)
+
+
+def parse_output(output):
+    results = {"cycles": {}, "isr": {}, "latency": None, "throughput": {}, "stats": {}}
+    for line in output.splitlines():
+        match = BENCH_RE.search(line)
+        if match:
+            results["cycles"][match.group(1)] = {"min": int(match.group(2)), "avg": int(match.group(3))}
+            continue
+        match = ISR_RE.search(line)
+        if match:
+            results["isr"][match.group(1)] = {"count": int(match.group(2)), "min": int(match.group(3)),
+                                             "avg": int(match.group(4)), "max": int(match.group(5))}
+            continue
+        match = LATENCY_RE.search(line)
+        if match:
+            results["latency"] = {"min": int(match.group(1)), "max": int(match.group(2))}
+            continue
+        match = THROUGHPUT_RE.search(line)
+        if match:
+            results["throughput"][match.group(1)] = {"units": int(match.group(2)), "cycles": int(match.group(3)),
+                                                    "ideal": int(match.group(4))}
+            continue
+        match = STAT_RE.search(line)
+        if match:
+            results["stats"][match.group(1)] = int(match.group(2))
+    if "DONE" not in output:
+        raise RuntimeError("benchmark firmware did not finish:\n" + output)
+    return results
+
+
+def module_footprint(avr_size, library):
+    # Berkeley format: text data bss dec hex filename, one line per archive member
+    output = subprocess.run([avr_size, library], stdout=subprocess.PIPE,
+                            universal_newlines=True, check=True).stdout
+    modules = {}
+    for line in output.splitlines()[1:]:
+        fields = line.split()
+        if len(fields) < 6:
+            continue
+        name = re.sub(r"\.cpp\.o(bj)?$", "", fields[5])
+        text, data, bss = int(fields[0]), int(fields[1]), int(fields[2])
+        modules[name] = {"flash": text + data, "ram": data + bss}
+    return modules
+
+
+def flatten(results, prefix=""):
+    values = {}
+    for key, value in results.items():
+        if isinstance(value, dict):
+            values.update(flatten(value, prefix + key + "."))
+        elif isinstance(value, int):
+            values[prefix + key] = value
+    return values
+
+
+def compare(results, baseline, tolerance):
+    # Lower is better for every metric except ISR counts, which only depend on the window
+    current, previous = flatten(results), flatten(baseline)
+    failures = []
+    for key, old in sorted(previous.items()):
+        if key.endswith(".count") or key.endswith("latency.min") or key not in current:
+            continue
+        limit = old * (1 + tolerance / 100.0)
+        if current[key] > limit and current[key] - old > 1:
+            failures.append("%s: %d -> %d (limit %d)" % (key, old, current[key], limit))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--simavr", default="simavr")
+    parser.add_argument("--avr-size", default="avr-size")
+    parser.add_argument("--elf", required=True)
+    parser.add_argument("--library", required=True)
+    parser.add_argument("--mcu", default="atmega328p")
+    parser.add_argument("--frequency", type=int, default=16000000)
+    parser.add_argument("--output", required=True)
+    parser.add_argument("--baseline")
+    parser.add_argument("--tolerance", type=float, default=5.0, help="allowed growth in percent")
+    parser.add_argument("--timeout", type=int, default=120)
+    args = parser.parse_args()
+
+    results = parse_output(run_firmware(args.simavr, args.elf, args.mcu, args.frequency, args.timeout))
+    results["footprint"] = module_footprint(args.avr_size, args.library)
+
+    with open(args.output, "w") as out:
+        json.dump(results, out, indent=2, sort_keys=True)
+
+    for name, cycles in sorted(results["cycles"].items()):
+        print("%-24s %8d %8d cycles (min, avg)" % (name, cycles["min"], cycles["avg"]))
+    for name, isr in sorted(results["isr"].items()):
+        print("%-24s %8d %8d %8d cycles (min, avg, max)" % (name, isr["min"], isr["avg"], isr["max"]))
+    if results["latency"]:
+        print("%-24s %8d %8d cycles (min, max)" % ("interrupt latency", results["latency"]["min"], results["latency"]["max"]))
+    for name, rate in sorted(results["throughput"].items()):
+        # Units per second at the simulated clock, and the share of the hardware limit if there is one
+        per_second = rate["units"] * args.frequency // max(rate["cycles"], 1)
+        line = "%-24s %8d units/s" % (name, per_second)
+        if rate["ideal"]:
+            line += " (%d%% of %d)" % (100 * rate["ideal"] // max(rate["cycles"], 1), rate["units"] * args.frequency // rate["ideal"])
+        print(line)
+    for name, value in sorted(results["stats"].items()):
+        print("%-24s %8d" % (name, value))
+    for name, size in sorted(results["footprint"].items()):
+        print("%-24s %8d %8d bytes (flash, ram)" % (name, size["flash"], size["ram"]))
+    print("results written to " + args.output)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            failures = compare(results, json.load(f), args.tolerance)
+        if failures:
+            print("regressions over %.1f%%:" % args.tolerance)
+            for failure in failures:
+                print("  " + failure)
+            return 1
+        print("no regressions over %.1f%% against %s" % (args.tolerance, args.baseline))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
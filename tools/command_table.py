@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""
+AVRLite command table generator (Command.h), run by CMake for every src/<name>.cmd file.
+
+Reads one command per line, "name signature handler" (signature letters i, u, q, s or - for
+none, # starts a comment), and writes <name>_commands.h with a flash-resident perfect-hash
+table (hash and displace): names are hashed into buckets, and every bucket gets a displacement
+that sends its names to free slots of the smallest power-of-two table.
+
+  command_table.py example8.cmd --output example8_commands.h
+"""
+
+import argparse
+import os
+import re
+import sys
+
+NAME_RE = re.compile(r"^[A-Za-z0-9_.?!+-]+$")
+HANDLER_RE = re.compile(r"^[A-Za-z_][A-Za-z0-9_]*$")
+SIGNATURE_LETTERS = set("iuqs")
+
+
+def command_hash(seed, name):
+    # Same as __CommandHash__ in Command.h
+    h = seed
+    for c in name.encode("ascii"):
+        h = ((h ^ c) * 0x9E37) & 0xFFFF
+    return h ^ (h >> 8)
+
+
+def command_slot(h, displacement, size):
+    # Same as __CommandSlot__ in Command.h
+    return ((h >> 8) + displacement * (((h >> 4) & 0xFF) | 1)) & (size - 1)
+
+
+def parse_spec(path):
+    commands = []
+    with open(path) as spec:
+        for number, line in enumerate(spec, 1):
+            fields = line.split("#", 1)[0].split()
+            if not fields:
+                continue
+            if len(fields) != 3:
+                sys.exit("%s:%d: expected \"name signature handler\"" % (path, number))
+            name, signature, handler = fields
+            if signature == "-":
+                signature = ""
+            if not NAME_RE.match(name):
+                sys.exit("%s:%d: invalid command name '%s'" % (path, number, name))
+            if not set(signature) <= SIGNATURE_LETTERS:
+                sys.exit("%s:%d: signature letters are i, u, q and s" % (path, number))
+            if not HANDLER_RE.match(handler):
+                sys.exit("%s:%d: invalid handler name '%s'" % (path, number, handler))
+            if any(name == other[0] for other in commands):
+                sys.exit("%s:%d: duplicate command '%s'" % (path, number, name))
+            commands.append((name, signature, handler))
+    if not commands:
+        sys.exit("%s: no commands" % path)
+    return commands
+
+
+def place(names, seed, size, buckets):
+    hashes = [command_hash(seed, name) for name in names]
+    members = {}
+    for h in hashes:
+        members.setdefault(h & (buckets - 1), []).append(h)
+
+    # Largest buckets first, while most slots are still free
+    used = set()
+    displacements = [0] * buckets
+    for bucket, group in sorted(members.items(), key=lambda item: -len(item[1])):
+        for displacement in range(256):
+            slots = {command_slot(h, displacement, size) for h in group}
+            if len(slots) == len(group) and not slots & used:
+                used |= slots
+                displacements[bucket] = displacement
+                break
+        else:
+            return None
+    return displacements
+
+
+def find_table(names):
+    size = 1
+    while size < len(names):
+        size *= 2
+    while size <= 256:
+        for buckets in sorted({max(1, size // 4), max(1, size // 2)}):
+            for seed in range(256):
+                displacements = place(names, seed, size, buckets)
+                if displacements is not None:
+                    return seed, size, displacements
+        size *= 2
+    sys.exit("no perfect hash for %d commands" % len(names))
+
+
+def c_identifier(text):
+    return re.sub(r"[^A-Za-z0-9_]", "_", text)
+
+
+def write_header(path, source, commands, seed, size, displacements):
+    guard = c_identifier(os.path.basename(path))
+    slots = [None] * size
+    for command in commands:
+        h = command_hash(seed, command[0])
+        slots[command_slot(h, displacements[h & (len(displacements) - 1)], size)] = command
+
+    lines = [
+        "// Generated by tools/command_table.py from %s, do not edit" % os.path.basename(source),
+        "#ifndef %s" % guard,
+        "#define %s" % guard,
+        "",
+        "#include \"Command.h\"",
+        "",
+        "// Handlers, defined by the firmware",
+    ]
+    for handler in sorted({command[2] for command in commands}):
+        lines.append("void %s(const Command_Arg *args);" % handler)
+    lines.append("")
+
+    for index, (name, signature, handler) in enumerate(commands):
+        lines.append("static const char command_name_%d[] PROGMEM = \"%s\";" % (index, name))
+    for signature in sorted({command[1] for command in commands}):
+        lines.append("static const char command_signature_%s[] PROGMEM = \"%s\";" % (signature or "none", signature))
+    lines.append("")
+
+    longest = max(len(command[1]) for command in commands)
+    lines.append("static_assert(%d <= COMMAND_MAX_ARGS, \"%s: raise COMMAND_MAX_ARGS\");"
+                 % (longest, os.path.basename(source)))
+    lines.append("")
+
+    lines.append("// %d commands in %d slots, %d buckets, seed %d" % (len(commands), size, len(displacements), seed))
+    lines.append("static const uint8_t command_displacement[%d] PROGMEM = {%s};"
+                 % (len(displacements), ", ".join(str(d) for d in displacements)))
+    lines.append("static const Command_Entry command_slots[%d] PROGMEM = {" % size)
+    for slot in slots:
+        if slot is None:
+            lines.append("    {NULL, NULL, NULL},")
+        else:
+            name, signature, handler = slot
+            lines.append("    {command_name_%d, command_signature_%s, %s},"
+                         % (commands.index(slot), signature or "none", handler))
+    lines.append("};")
+    lines.append("")
+    lines.append("static const Command_Table command_table = {%d, %d, %d, command_displacement, command_slots};"
+                 % (seed, size - 1, len(displacements) - 1))
+    lines.append("")
+    lines.append("#endif")
+
+    with open(path, "w") as header:
+        header.write("\n".join(lines) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("spec")
+    parser.add_argument("--output", required=True)
+    args = parser.parse_args()
+
+    commands = parse_spec(args.spec)
+    seed, size, displacements = find_table([command[0] for command in commands])
+    write_header(args.output, args.spec, commands, seed, size, displacements)
+
+
+if __name__ == "__main__":
+    main()
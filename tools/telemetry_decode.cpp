@@ -0,0 +1,179 @@
+/**
+ * @file telemetry_decode.cpp
+ * @brief Host-side decoder for the AVRLite binary telemetry stream (Telemetry.h)
+ * Reads COBS-framed packets from a serial port or stdin, checks the CRC-16 and prints
+ * one CSV line per record: seq,timestamp_us,id,type,value
+ *
+ * @details
+ * - Build on Linux: g++ -O2 -o telemetry_decode tools/telemetry_decode.cpp
+ * - Serial port:    ./telemetry_decode /dev/ttyUSB0 1000000
+ * - Captured file:  ./telemetry_decode - < capture.bin
+ * - Sequence gaps, CRC errors and malformed frames are reported on stderr.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+
+// Must match Telemetry.h
+#define TELEMETRY_HEADER_SIZE 5
+#define TELEMETRY_U8    0x0
+#define TELEMETRY_I8    0x1
+#define TELEMETRY_U16   0x2
+#define TELEMETRY_I16   0x3
+#define TELEMETRY_U32   0x4
+#define TELEMETRY_I32   0x5
+#define TELEMETRY_FLOAT 0x6
+
+static const char *type_names[] = {"u8", "i8", "u16", "i16", "u32", "i32", "float"};
+static const uint8_t type_sizes[] = {1, 1, 2, 2, 4, 4, 4};
+
+// Same polynomial as _crc_ccitt_update() in avr-libc <util/crc16.h>
+static uint16_t crc_ccitt_update(uint16_t crc, uint8_t data) {
+    data ^= (uint8_t)(crc & 0xFF);
+    data ^= data << 4;
+    return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+}
+
+// Decode one COBS block (without the 0x00 delimiter), returns the decoded length or -1
+static int cobs_decode(const uint8_t *in, int length, uint8_t *out) {
+    int read = 0, written = 0;
+    while (read < length) {
+        uint8_t code = in[read++];
+        if (code == 0 || read + code - 1 > length)
+            return -1;
+        for (uint8_t i = 1; i < code; i++)
+            out[written++] = in[read++];
+        if (read < length)
+            out[written++] = 0;
+    }
+    return written;
+}
+
+static speed_t baud_constant(long baud) {
+    switch (baud) {
+        case 9600:    return B9600;
+        case 19200:   return B19200;
+        case 38400:   return B38400;
+        case 57600:   return B57600;
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 500000:  return B500000;
+        case 1000000: return B1000000;
+        case 2000000: return B2000000;
+    }
+    return 0;
+}
+
+static int open_port(const char *path, long baud) {
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    if (fd < 0) {
+        perror(path);
+        return -1;
+    }
+
+    struct termios tty;
+    tcgetattr(fd, &tty);
+    cfmakeraw(&tty);
+    speed_t speed = baud_constant(baud);
+    if (speed == 0) {
+        fprintf(stderr, "unsupported baud rate %ld\n", baud);
+        close(fd);
+        return -1;
+    }
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    tty.c_cc[VMIN] = 1;
+    tty.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &tty);
+    return fd;
+}
+
+static unsigned long frames, crc_errors, malformed, lost;
+static int last_seq = -1;
+
+static void print_frame(const uint8_t *frame, int length) {
+    uint16_t crc = 0xFFFF;
+    for (int i = 0; i < length - 2; i++)
+        crc = crc_ccitt_update(crc, frame[i]);
+    if (crc != (frame[length - 2] | (frame[length - 1] << 8))) {
+        crc_errors++;
+        return;
+    }
+    length -= 2;
+
+    uint8_t seq = frame[0];
+    uint32_t timestamp;
+    memcpy(&timestamp, &frame[1], sizeof(timestamp));
+    if (last_seq >= 0 && seq != (uint8_t)(last_seq + 1)) {
+        uint8_t gap = seq - (uint8_t)(last_seq + 1);
+        lost += gap;
+        fprintf(stderr, "sequence gap: %u frame(s) lost before %u\n", gap, seq);
+    }
+    last_seq = seq;
+    frames++;
+
+    int pos = TELEMETRY_HEADER_SIZE;
+    while (pos < length) {
+        uint8_t type = frame[pos] >> 5, id = frame[pos] & 0x1F;
+        pos++;
+        if (type > TELEMETRY_FLOAT || pos + type_sizes[type] > length) {
+            malformed++;
+            return;
+        }
+
+        printf("%u,%lu,%u,%s,", seq, (unsigned long)timestamp, id, type_names[type]);
+        switch (type) {
+            case TELEMETRY_U8:  printf("%u\n", frame[pos]); break;
+            case TELEMETRY_I8:  printf("%d\n", (int8_t)frame[pos]); break;
+            case TELEMETRY_U16: { uint16_t v; memcpy(&v, &frame[pos], 2); printf("%u\n", v); break; }
+            case TELEMETRY_I16: { int16_t v;  memcpy(&v, &frame[pos], 2); printf("%d\n", v); break; }
+            case TELEMETRY_U32: { uint32_t v; memcpy(&v, &frame[pos], 4); printf("%lu\n", (unsigned long)v); break; }
+            case TELEMETRY_I32: { int32_t v;  memcpy(&v, &frame[pos], 4); printf("%ld\n", (long)v); break; }
+            case TELEMETRY_FLOAT: { float v;  memcpy(&v, &frame[pos], 4); printf("%g\n", v); break; }
+        }
+        pos += type_sizes[type];
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <serial-port> [baud] | %s -\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    int fd = 0;
+    if (strcmp(argv[1], "-") != 0) {
+        fd = open_port(argv[1], argc > 2 ? atol(argv[2]) : 115200);
+        if (fd < 0)
+            return 1;
+    }
+
+    uint8_t block[512], frame[512], chunk[256];
+    int block_length = 0;
+    ssize_t n;
+    while ((n = read(fd, chunk, sizeof(chunk))) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            if (chunk[i] != 0x00) {
+                if (block_length < (int)sizeof(block))
+                    block[block_length++] = chunk[i];
+                continue;
+            }
+
+            int length = cobs_decode(block, block_length, frame);
+            if (length >= TELEMETRY_HEADER_SIZE + 2)
+                print_frame(frame, length);
+            else if (block_length > 0)
+                malformed++;
+            block_length = 0;
+        }
+        fflush(stdout);
+    }
+
+    fprintf(stderr, "%lu frames, %lu lost, %lu CRC errors, %lu malformed\n", frames, lost, crc_errors, malformed);
+    return 0;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file trace2vcd.cpp
+ * @brief Host-side converter from an AVRLite pin trace dump (Trace.h) to a VCD file
+ * Finds the last complete "AVTR" dump in the input, which may be mixed with other Serial
+ * output, and writes a Value Change Dump with a 1 us timescale for GTKWave or similar.
+ *
+ * @details
+ * - Build on Linux: g++ -O2 -o trace2vcd tools/trace2vcd.cpp
+ * - Capture:        stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > dump.bin
+ * - Convert:        ./trace2vcd dump.bin > trace.vcd   (or ./trace2vcd - < dump.bin)
+ * - Signals: D0..D13/A0..A5 levels, <pin>_out (pin direction), <pin>_pwm (8 bits),
+ *   <pin>_adc (10 bits) and markN (16 bits), declared only when they occur in the dump.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+// Must match Trace.h
+#define TRACE_DUMP_VERSION 1
+#define TRACE_HEADER_SIZE  10
+#define TRACE_RECORD_SIZE  5
+#define TRACE_WRITE 0x0
+#define TRACE_MODE  0x1
+#define TRACE_PWM   0x2
+#define TRACE_ADC   0x3
+#define TRACE_MARK  0x4
+#define TRACE_TIME  0x7
+
+static const char *suffixes[] = {"", "_out", "_pwm", "_adc"};
+static const uint8_t widths[] = {1, 1, 8, 10, 16};
+
+struct Signal {
+    char name[16];
+    char id[3];
+    uint8_t width;
+};
+
+static uint16_t read16(const uint8_t *p) { return p[0] | (p[1] << 8); }
+
+static void signal_name(uint8_t kind, uint8_t pin, char *name, size_t size) {
+    if (kind == TRACE_MARK)
+        snprintf(name, size, "mark%u", pin);
+    else if (pin >= 14)
+        snprintf(name, size, "A%u%s", pin - 14, suffixes[kind]);
+    else
+        snprintf(name, size, "D%u%s", pin, suffixes[kind]);
+}
+
+static void print_value(const Signal &signal, uint16_t value) {
+    if (signal.width == 1) {
+        printf("%u%s\n", value ? 1 : 0, signal.id);
+        return;
+    }
+    printf("b");
+    for (int bit = signal.width - 1; bit >= 0; bit--)
+        putchar((value >> bit) & 1 ? '1' : '0');
+    printf(" %s\n", signal.id);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <dump-file> | %s -\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    FILE *in = strcmp(argv[1], "-") == 0 ? stdin : fopen(argv[1], "rb");
+    if (!in) {
+        perror(argv[1]);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), in)) > 0)
+        data.insert(data.end(), chunk, chunk + n);
+
+    // Last complete dump in the stream
+    long start = -1;
+    for (size_t i = 0; i + TRACE_HEADER_SIZE <= data.size(); i++) {
+        if (memcmp(&data[i], "AVTR", 4) != 0 || data[i + 4] != TRACE_DUMP_VERSION)
+            continue;
+        if (i + TRACE_HEADER_SIZE + data[i + 5] * TRACE_RECORD_SIZE <= data.size())
+            start = i;
+    }
+    if (start < 0) {
+        fprintf(stderr, "no complete trace dump found\n");
+        return 1;
+    }
+
+    const uint8_t *header = &data[start];
+    uint8_t count = header[5];
+    uint32_t time = read16(header + 6) | ((uint32_t)read16(header + 8) << 16);
+    const uint8_t *records = header + TRACE_HEADER_SIZE;
+
+    // Declare one signal per (kind, pin) that occurs, indexed by the record tag
+    Signal *signals[256] = {};
+    std::vector<Signal> declared;
+    declared.reserve(256);
+    for (int i = 0; i < count; i++) {
+        uint8_t tag = records[i * TRACE_RECORD_SIZE];
+        uint8_t kind = tag >> 5;
+        if (kind > TRACE_MARK || signals[tag])
+            continue;
+        Signal signal;
+        signal_name(kind, tag & 0x1F, signal.name, sizeof(signal.name));
+        signal.width = widths[kind];
+        int index = declared.size();
+        signal.id[0] = '!' + index % 94;
+        signal.id[1] = index >= 94 ? '!' + index / 94 : 0;
+        signal.id[2] = 0;
+        declared.push_back(signal);
+        signals[tag] = &declared.back();
+    }
+
+    printf("$version AVRLite trace2vcd $end\n");
+    printf("$timescale 1us $end\n");
+    printf("$scope module avrlite $end\n");
+    for (const Signal &signal : declared)
+        printf("$var %s %u %s %s $end\n", signal.width == 1 ? "wire" : "reg", signal.width, signal.id, signal.name);
+    printf("$upscope $end\n$enddefinitions $end\n");
+
+    // Unknown until the first record of each signal
+    printf("#%lu\n$dumpvars\n", (unsigned long)time);
+    for (const Signal &signal : declared)
+        printf(signal.width == 1 ? "x%s\n" : "bx %s\n", signal.id);
+    printf("$end\n");
+
+    uint32_t last_printed = time;
+    for (int i = 0; i < count; i++) {
+        const uint8_t *record = records + i * TRACE_RECORD_SIZE;
+        uint8_t tag = record[0];
+        uint16_t value = read16(record + 1);
+        uint16_t delta = read16(record + 3);
+
+        if ((tag >> 5) == TRACE_TIME) {
+            time += ((uint32_t)value << 16) | delta;
+            continue;
+        }
+        time += delta;
+        if (!signals[tag])
+            continue;
+        if (time != last_printed) {
+            printf("#%lu\n", (unsigned long)time);
+            last_printed = time;
+        }
+        print_value(*signals[tag], value);
+    }
+
+    fprintf(stderr, "%u records, %zu signals, %lu us\n", count, declared.size(),
+            (unsigned long)(time - (read16(header + 6) | ((uint32_t)read16(header + 8) << 16))));
+    return 0;
+}